@@ -4,9 +4,16 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#include "sdkconfig.h"
 #include "esp_err.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "modbus_rtu_host_types.h"
+#else
 #include "driver/uart.h"
 #include "driver/gpio.h"
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -19,6 +26,8 @@ extern "C" {
 #define ESP_ERR_MODBUS_RTU_BAD_RESPONSE   (ESP_ERR_MODBUS_RTU_BASE + 3)
 #define ESP_ERR_MODBUS_RTU_EXCEPTION      (ESP_ERR_MODBUS_RTU_BASE + 4)
 #define ESP_ERR_MODBUS_RTU_PORT           (ESP_ERR_MODBUS_RTU_BASE + 5)
+#define ESP_ERR_MODBUS_RTU_FRAME          (ESP_ERR_MODBUS_RTU_BASE + 6) // line error or t1.5 violation
+#define ESP_ERR_MODBUS_RTU_OFFLINE        (ESP_ERR_MODBUS_RTU_BASE + 7) // unit quarantined, request not sent
 
 typedef struct {
     uint8_t function;
@@ -27,7 +36,30 @@ typedef struct {
 
 typedef struct modbus_rtu_s modbus_rtu_t;
 
+// Data tables; values equal the read function code of each table
+typedef enum {
+    MODBUS_RTU_TABLE_COILS           = 0x01,
+    MODBUS_RTU_TABLE_DISCRETE_INPUTS = 0x02,
+    MODBUS_RTU_TABLE_HOLDING         = 0x03,
+    MODBUS_RTU_TABLE_INPUT           = 0x04,
+} modbus_rtu_table_t;
+
+// ------------ Character timing ------------
+// Derived from baud rate, data bits, parity and stop bits. Above 19200 baud
+// t1.5/t3.5 use the fixed 750/1750 us from the Modbus serial line spec.
+typedef struct {
+    uint32_t char_time_us;           // one character incl. start/parity/stop bits
+    uint32_t t15_us;                 // max gap between characters of a frame
+    uint32_t t35_us;                 // min gap between frames
+    uint32_t inter_frame_timeout_us; // end-of-frame gap actually in use
+} modbus_rtu_timing_t;
+
 // ------------ UART / RS485 config ------------
+typedef enum {
+    MODBUS_RTU_RX_POLL = 0,   // poll uart_read_bytes() and time the idle gap in software
+    MODBUS_RTU_RX_EVENT,      // block on the UART event queue; hardware RX timeout ends the frame
+} modbus_rtu_rx_mode_t;
+
 typedef struct {
     uart_port_t uart_num;
 
@@ -51,18 +83,65 @@ typedef struct {
     int rx_buf_size;          // default if 0
     int tx_buf_size;          // default if 0
     int uart_event_queue_size;// default if 0
+
+    modbus_rtu_rx_mode_t rx_mode;
+
+    // Optional transport backend. NULL = built-in ESP-IDF UART driver, in
+    // which case the UART/RS485 fields above apply. Otherwise only the
+    // character format (baudrate, parity, stop_bits, data_bits) is used to
+    // derive timing and everything else is up to the backend.
+    const struct modbus_rtu_transport_s *transport;
+    void *transport_ctx;
 } modbus_rtu_uart_config_t;
 
+// ------------ Transport ------------
+// A transport moves whole RTU ADUs (unit id .. CRC) on and off the line.
+typedef struct {
+    const modbus_rtu_uart_config_t *uart;
+    modbus_rtu_timing_t timing;   // inter_frame_timeout_us already resolved
+    int txrx_turnaround_us;
+    bool enforce_t15;
+} modbus_rtu_transport_params_t;
+
+// Total ADU length implied by the first len bytes of a frame, 0 while it
+// cannot be told yet (or at all)
+typedef size_t (*modbus_rtu_frame_len_fn_t)(const uint8_t *adu, size_t len, void *arg);
+
+typedef struct modbus_rtu_transport_s {
+    esp_err_t (*init)(void *ctx, const modbus_rtu_transport_params_t *params);
+    // Blocks until the ADU is on the wire; discards any pending RX data first.
+    esp_err_t (*write_adu)(void *ctx, const uint8_t *adu, size_t adu_len);
+    // Returns one complete frame once the line has been idle for the
+    // inter-frame gap. overall_timeout_ms < 0 waits forever.
+    esp_err_t (*read_frame)(void *ctx, uint8_t *buf, size_t buf_len, size_t *out_len, int overall_timeout_ms);
+    void      (*deinit)(void *ctx);
+    // Optional, used by the master for responses: as read_frame, but returns
+    // as soon as predict() gives a length that has been received. The idle
+    // gap only ends frames whose length cannot be predicted.
+    esp_err_t (*read_frame_expect)(void *ctx, uint8_t *buf, size_t buf_len, size_t *out_len, int overall_timeout_ms,
+                                   modbus_rtu_frame_len_fn_t predict, void *arg);
+} modbus_rtu_transport_t;
+
 // ------------ Master config ------------
 typedef struct {
     int response_timeout_ms;
-    int inter_frame_timeout_us;
+    int inter_frame_timeout_us; // 0 = auto (t3.5)
     int txrx_turnaround_us;  // for manual DE/RE
+    bool enforce_t15;        // drop frames with a t1.5..t3.5 gap (RX_EVENT only)
+    int broadcast_turnaround_ms; // bus quiet time after a broadcast: 0 = 100 ms, < 0 = none
     bool strict_unit_id;
     bool strict_function;
+    // End responses by the idle gap only. By default a response is complete
+    // as soon as the length given by its header has arrived (not with
+    // enforce_t15); the t3.5 gap is then kept before the next request.
+    bool wait_frame_gap;
 } modbus_rtu_master_config_t;
 
 // ------------ Slave callbacks ------------
+// Bit callbacks work on packed bits (LSB first, as on the wire); dest_bits is
+// zeroed and points straight into the response. Register callbacks use host
+// order words. Return ESP_ERR_NOT_SUPPORTED for ILLEGAL_FUNCTION, any other
+// error for ILLEGAL_DATA_ADDR.
 typedef esp_err_t (*modbus_rtu_read_bits_cb_t)(uint16_t addr, uint16_t qty, uint8_t *dest_bits, void *user);
 typedef esp_err_t (*modbus_rtu_write_bits_cb_t)(uint16_t addr, uint16_t qty, const uint8_t *src_bits, void *user);
 
@@ -92,13 +171,57 @@ typedef struct {
     modbus_rtu_custom_fc_cb_t  custom_function;
 } modbus_rtu_slave_cb_t;
 
+// ------------ Register bank ------------
+// Registers shared between the application and the slave engine under a
+// sequence lock. Neither side takes a mutex: a reader retries if a write
+// overlapped its copy, so every multi-register read (e.g. a 32-bit value in
+// two registers) is a consistent snapshot. Writers exclude each other with a
+// compare-and-swap; contention falls back to a one-tick delay so a preempted
+// lower-priority writer can finish. Keep writes short.
+typedef struct {
+    uint32_t seq;       // odd while a write is in progress
+    uint16_t count;
+    uint16_t *regs;
+} modbus_rtu_reg_bank_t;
+
+esp_err_t modbus_rtu_reg_bank_init(modbus_rtu_reg_bank_t *bank, uint16_t *storage, uint16_t count);
+esp_err_t modbus_rtu_reg_bank_write(modbus_rtu_reg_bank_t *bank, uint16_t offset, const uint16_t *src, uint16_t n);
+esp_err_t modbus_rtu_reg_bank_read(modbus_rtu_reg_bank_t *bank, uint16_t offset, uint16_t *dst, uint16_t n);
+
+// ------------ Slave data model ------------
+// Optional built-in register map served without callbacks. Each table is an
+// array of regions sorted by start address and non-overlapping; lookup is a
+// binary search and responses are serialized straight from storage. A region
+// with neither storage nor bank is virtual and goes to the matching callback,
+// as do requests that do not fit inside a single region.
+typedef struct {
+    uint16_t start;
+    uint16_t count;
+    void *storage;      // uint16_t[count] for registers, uint8_t[(count+7)/8] packed LSB first for bits
+    modbus_rtu_reg_bank_t *bank;    // registers only, instead of storage; bank register 0 = start
+} modbus_rtu_region_t;
+
+typedef struct {
+    const modbus_rtu_region_t *regions;
+    size_t count;
+} modbus_rtu_region_table_t;
+
+typedef struct {
+    modbus_rtu_region_table_t coils;
+    modbus_rtu_region_table_t discrete_inputs;
+    modbus_rtu_region_table_t holding;
+    modbus_rtu_region_table_t input;
+} modbus_rtu_data_model_t;
+
 // ------------ Slave config ------------
 typedef struct {
-    uint8_t unit_id;             // 1..247
-    int inter_frame_timeout_us;
+    uint8_t unit_id;             // 1..247, or 0 for no default unit (units added later)
+    int inter_frame_timeout_us;  // 0 = auto (t3.5)
+    bool enforce_t15;            // drop frames with a t1.5..t3.5 gap (RX_EVENT only)
     int rx_poll_delay_ms;
     int txrx_turnaround_us;      // for manual DE/RE
     size_t max_adu_size;         // default 256
+    const modbus_rtu_data_model_t *data_model; // optional, default unit; must outlive the slave
 } modbus_rtu_slave_config_t;
 
 // ------------ Create/destroy ------------
@@ -106,17 +229,32 @@ esp_err_t modbus_rtu_master_create(const modbus_rtu_uart_config_t *uart_cfg,
                                   const modbus_rtu_master_config_t *master_cfg,
                                   modbus_rtu_t **out);
 
+// callbacks may be NULL when slave_cfg->data_model covers everything served
 esp_err_t modbus_rtu_slave_create(const modbus_rtu_uart_config_t *uart_cfg,
                                  const modbus_rtu_slave_config_t *slave_cfg,
                                  const modbus_rtu_slave_cb_t *callbacks,
                                  void *user_ctx,
                                  modbus_rtu_t **out);
 
+// Slave farm: one RX task serving several unit ids, each with its own
+// callbacks and/or data model and user context. Dispatch is a direct table
+// index. Units can be added and removed while the slave runs; remove waits
+// for a request in progress to finish.
+esp_err_t modbus_rtu_slave_add_unit(modbus_rtu_t *mb, uint8_t unit_id,
+                                   const modbus_rtu_slave_cb_t *callbacks,
+                                   const modbus_rtu_data_model_t *data_model,
+                                   void *user_ctx);
+esp_err_t modbus_rtu_slave_remove_unit(modbus_rtu_t *mb, uint8_t unit_id);
+
 esp_err_t modbus_rtu_slave_start(modbus_rtu_t *mb);
 esp_err_t modbus_rtu_slave_stop(modbus_rtu_t *mb);
 
 void modbus_rtu_destroy(modbus_rtu_t *mb);
 
+// ------------ Timing ------------
+esp_err_t modbus_rtu_calc_timing(const modbus_rtu_uart_config_t *uart_cfg, modbus_rtu_timing_t *out);
+esp_err_t modbus_rtu_get_timing(const modbus_rtu_t *mb, modbus_rtu_timing_t *out);
+
 // ------------ Master helpers ------------
 esp_err_t modbus_rtu_read_coils(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
                                uint8_t *out_bits, size_t out_bits_len, modbus_rtu_exception_t *ex);
@@ -153,19 +291,582 @@ esp_err_t modbus_rtu_readwrite_multiple_registers(modbus_rtu_t *mb, uint8_t unit
                                                  uint16_t *out_read_regs, size_t out_read_regs_len,
                                                  modbus_rtu_exception_t *ex);
 
+// Packed bitfields, as on the wire: bit n is bit n % 8 of byte n / 8, for
+// (qty + 7) / 8 bytes. Unused bits of the last byte read back as 0 and are
+// sent as 0. No per-bit expansion: 8x smaller buffers than the calls above.
+esp_err_t modbus_rtu_read_coils_packed(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
+                                      uint8_t *out_bytes, size_t out_bytes_len, modbus_rtu_exception_t *ex);
+
+esp_err_t modbus_rtu_read_discrete_inputs_packed(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
+                                                uint8_t *out_bytes, size_t out_bytes_len, modbus_rtu_exception_t *ex);
+
+esp_err_t modbus_rtu_write_multiple_coils_packed(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
+                                                const uint8_t *bytes, size_t bytes_len, modbus_rtu_exception_t *ex);
+
+// ------------ Zero-copy frames ------------
+#define MODBUS_RTU_ADU_MAX 256
+#define MODBUS_RTU_PDU_MAX 253
+
+// One ADU buffer with headroom for the unit id and tailroom for the CRC.
+// Encode the request PDU in place at modbus_rtu_frame_pdu(); the response
+// arrives in the same buffer and is returned as a view into it, valid until
+// the frame is reused. The pad byte keeps register payloads (PDU + 2) aligned.
+typedef struct {
+    uint8_t pad;
+    uint8_t adu[MODBUS_RTU_ADU_MAX];
+    size_t adu_len;
+} modbus_rtu_frame_t;
+
+static inline uint8_t *modbus_rtu_frame_pdu(modbus_rtu_frame_t *f) { return &f->adu[1]; }
+
+// *response_pdu is NULL for broadcasts (unit_id 0). A broadcast returns once
+// sent; the next transaction waits out the broadcast turnaround delay.
+esp_err_t modbus_rtu_master_transaction_frame(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_frame_t *frame,
+                                             size_t request_pdu_len,
+                                             const uint8_t **response_pdu, size_t *response_pdu_len,
+                                             modbus_rtu_exception_t *ex);
+
 // Low-level transaction: request PDU in, response PDU out (no unit-id/CRC)
 esp_err_t modbus_rtu_master_transaction(modbus_rtu_t *mb, uint8_t unit_id,
                                        const uint8_t *request_pdu, size_t request_pdu_len,
                                        uint8_t *response_pdu, size_t response_pdu_max, size_t *response_pdu_len,
                                        modbus_rtu_exception_t *ex);
 
+// ------------ Static allocation ------------
+// Handles created from caller storage: no heap is used for the handle, its
+// mutex, the slave RX buffer or the slave task (xSemaphoreCreateMutexStatic,
+// xTaskCreateStatic). The storage must stay untouched until
+// modbus_rtu_destroy(), which releases the handle but frees nothing.
+// Heap is still used by the UART driver, the esp_timers (master bus idle,
+// enforce_t15), by units added with modbus_rtu_slave_add_unit() and by the
+// optional async, cache, adaptive and scheduler features; per-unit
+// statistics are not kept (bus totals are).
+#if CONFIG_MODBUS_RTU_STATS
+#define MODBUS_RTU_HANDLE_SIZE (512 * sizeof(void *) + 640)
+#else
+#define MODBUS_RTU_HANDLE_SIZE (256 * sizeof(void *) + 384)
+#endif
+
+#ifndef CONFIG_MODBUS_RTU_SLAVE_TASK_STACK
+#define CONFIG_MODBUS_RTU_SLAVE_TASK_STACK 4096
+#endif
+
+// Stack used below the caller, in bytes, logging off
+// (CONFIG_MODBUS_RTU_LOG_LEVEL=0), cache and adaptive timeouts on. The slave
+// figure is the whole RX task without the user callbacks' own frames.
+// Host-only figures: measured by examples/stack_usage on the x86-64 Linux
+// build over its in-memory queue transport (worst: read_typed through the
+// cache, 2000 at -Og). Not yet measured on Xtensa/RISC-V or with the UART
+// driver; run the example on the target before relying on them there.
+#define MODBUS_RTU_STACK_MASTER_CALL 2560   // blocking helpers, transaction(_frame), typed, span, batch
+#define MODBUS_RTU_STACK_SLAVE_TASK  1536
+
+typedef union {
+    uint8_t bytes[MODBUS_RTU_HANDLE_SIZE];
+    uint64_t align;
+    void *align_ptr;
+} modbus_rtu_handle_storage_t;
+
+typedef struct {
+    modbus_rtu_handle_storage_t handle;
+    StaticSemaphore_t mutex;
+    StaticSemaphore_t idle;         // bus-idle wake-up
+    StaticSemaphore_t async_lock;
+} modbus_rtu_master_static_t;
+
+// The RX buffer holds slave_cfg.max_adu_size bytes, at most MODBUS_RTU_ADU_MAX
+typedef struct {
+    modbus_rtu_handle_storage_t handle;
+    StaticSemaphore_t mutex;
+    StaticTask_t task;
+    StackType_t stack[CONFIG_MODBUS_RTU_SLAVE_TASK_STACK / sizeof(StackType_t)];
+    uint8_t rx[MODBUS_RTU_ADU_MAX];
+} modbus_rtu_slave_static_t;
+
+esp_err_t modbus_rtu_master_create_static(const modbus_rtu_uart_config_t *uart_cfg,
+                                         const modbus_rtu_master_config_t *master_cfg,
+                                         modbus_rtu_master_static_t *storage,
+                                         modbus_rtu_t **out);
+
+// The default unit is kept inside the handle
+esp_err_t modbus_rtu_slave_create_static(const modbus_rtu_uart_config_t *uart_cfg,
+                                        const modbus_rtu_slave_config_t *slave_cfg,
+                                        const modbus_rtu_slave_cb_t *callbacks,
+                                        void *user_ctx,
+                                        modbus_rtu_slave_static_t *storage,
+                                        modbus_rtu_t **out);
+
+// ------------ Compiled requests ------------
+// A recurring request encoded once: unit id, PDU and CRC sealed into an
+// immutable ADU, plus the exact response length where the function code
+// fixes it (a normal response of any other length is BAD_RESPONSE).
+// Running one skips encoding and CRC. Compiled requests are read-only and
+// can be shared between tasks and buses.
+typedef struct modbus_rtu_compiled_s modbus_rtu_compiled_t;
+
+// Copies the PDU; unit_id 0 compiles a broadcast
+esp_err_t modbus_rtu_compile(uint8_t unit_id, const uint8_t *pdu, size_t pdu_len, modbus_rtu_compiled_t **out);
+// Read request (function = table) for qty registers or bits
+esp_err_t modbus_rtu_compile_read(uint8_t unit_id, modbus_rtu_table_t table, uint16_t addr, uint16_t qty,
+                                  modbus_rtu_compiled_t **out);
+void      modbus_rtu_compiled_free(modbus_rtu_compiled_t *req);
+
+// As modbus_rtu_master_transaction_frame(); the response is a view into rx
+esp_err_t modbus_rtu_master_run_compiled(modbus_rtu_t *mb, const modbus_rtu_compiled_t *req, modbus_rtu_frame_t *rx,
+                                         const uint8_t **response_pdu, size_t *response_pdu_len,
+                                         modbus_rtu_exception_t *ex);
+
+// Runs in the caller's task with the bus held: must not call the master API.
+// response_pdu is only valid during the call (NULL for broadcasts and errors).
+typedef void (*modbus_rtu_batch_cb_t)(size_t index, esp_err_t err, const modbus_rtu_exception_t *ex,
+                                      const uint8_t *response_pdu, size_t response_pdu_len, void *user);
+
+// Runs count compiled requests back to back under one bus acquisition, so
+// no other task interleaves and frames are separated only by the t3.5 gap
+// (plus turnaround after broadcasts). A failed request does not stop the
+// batch. Returns the first error, or ESP_OK.
+esp_err_t modbus_rtu_master_run_batch(modbus_rtu_t *mb, const modbus_rtu_compiled_t *const *reqs, size_t count,
+                                      modbus_rtu_batch_cb_t cb, void *user);
+
+// ------------ Register spans ------------
+// Any register range, split into the largest legal frames (125 registers per
+// read, 123 per FC10 write) that run back to back under one bus acquisition.
+// Every chunk is attempted; with adaptive timeouts a dead unit is
+// quarantined after a few chunks and the rest fail fast with
+// ESP_ERR_MODBUS_RTU_OFFLINE. The per-chunk results say which sub-ranges to
+// retry, e.g. with the same call on chunk.addr / chunk.qty.
+#define MODBUS_RTU_READ_SPAN_CHUNKS(count)  (((count) + 124) / 125)
+#define MODBUS_RTU_WRITE_SPAN_CHUNKS(count) (((count) + 122) / 123)
+
+typedef struct {
+    uint16_t addr;
+    uint16_t qty;
+    esp_err_t err;
+    modbus_rtu_exception_t ex;
+} modbus_rtu_span_chunk_t;
+
+// addr + count must not pass 65536. chunks may be NULL; otherwise it needs
+// room for every chunk and *out_chunks gets the number written. Registers of
+// failed chunks are left untouched. Returns the first chunk error, or ESP_OK.
+esp_err_t modbus_rtu_read_span(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_table_t table, uint16_t addr,
+                               size_t count, uint16_t *out_regs,
+                               modbus_rtu_span_chunk_t *chunks, size_t max_chunks, size_t *out_chunks);
+// unit_id 0 broadcasts every chunk
+esp_err_t modbus_rtu_write_span(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr,
+                                size_t count, const uint16_t *regs,
+                                modbus_rtu_span_chunk_t *chunks, size_t max_chunks, size_t *out_chunks);
+
+// ------------ Async master ------------
+// Requests are queued and executed back to back by a dedicated bus task, so
+// producers never block on the wire. Completion is reported through a
+// callback (runs in the bus task, keep it short) and/or a task notification.
+
+typedef struct {
+    esp_err_t err;
+    uint8_t unit_id;
+    modbus_rtu_exception_t ex;
+    const uint8_t *response_pdu;   // valid during the callback only
+    size_t response_pdu_len;
+    void *user;
+    modbus_rtu_t *mb;              // handle that ran the request
+} modbus_rtu_async_result_t;
+
+typedef void (*modbus_rtu_async_cb_t)(const modbus_rtu_async_result_t *result);
+
+typedef struct {
+    uint8_t unit_id;
+    const uint8_t *request_pdu;    // copied by submit
+    size_t request_pdu_len;
+
+    modbus_rtu_async_cb_t callback; // optional
+    void *user;
+
+    // Optional notification: xTaskNotify(notify_task, notify_bits, eSetBits)
+    // after the result fields below have been written.
+    TaskHandle_t notify_task;
+    uint32_t notify_bits;
+
+    // Optional result storage, must stay valid until completion. A response
+    // longer than out_pdu_max completes with ESP_ERR_NO_MEM, also in the
+    // callback.
+    esp_err_t *out_err;
+    modbus_rtu_exception_t *out_ex;
+    uint8_t *out_pdu;
+    size_t out_pdu_max;
+    size_t *out_pdu_len;
+} modbus_rtu_async_req_t;
+
+typedef struct {
+    int queue_len;          // default 16
+    int task_stack;         // default 4096
+    int task_priority;      // default 10
+    bool pin_to_core;       // false = no affinity
+    int task_core;
+} modbus_rtu_async_config_t;
+
+esp_err_t modbus_rtu_master_async_start(modbus_rtu_t *mb, const modbus_rtu_async_config_t *cfg);
+// Pending requests complete with ESP_ERR_INVALID_STATE. A submit racing the
+// stop either gets queued before it (and fails that way) or returns
+// ESP_ERR_INVALID_STATE; still, do not submit while stop or
+// modbus_rtu_destroy() runs, as the handle itself goes away with destroy.
+esp_err_t modbus_rtu_master_async_stop(modbus_rtu_t *mb);
+// ESP_ERR_TIMEOUT if the queue stayed full for wait_ticks
+esp_err_t modbus_rtu_master_submit(modbus_rtu_t *mb, const modbus_rtu_async_req_t *req, TickType_t wait_ticks);
+
+// ------------ Bus manager ------------
+// Owns one master handle per RS-485 segment, each with its own async bus
+// task (priority and core set per bus), so segments run concurrently.
+// Requests are routed by a unit id -> bus map. Completion works as for
+// modbus_rtu_master_submit(); requests without a callback can instead be
+// collected from one shared result queue for all buses.
+typedef struct modbus_rtu_bus_mgr_s modbus_rtu_bus_mgr_t;
+
+typedef struct {
+    int max_buses;              // default 4
+    int result_queue_len;       // 0 = no shared result queue
+} modbus_rtu_bus_mgr_config_t;
+
+typedef struct {
+    int bus;
+    esp_err_t err;
+    uint8_t unit_id;
+    modbus_rtu_exception_t ex;
+    void *user;
+    size_t response_pdu_len;
+    uint8_t response_pdu[MODBUS_RTU_PDU_MAX];
+} modbus_rtu_bus_result_t;
+
+esp_err_t modbus_rtu_bus_mgr_create(const modbus_rtu_bus_mgr_config_t *cfg, modbus_rtu_bus_mgr_t **out);
+// Stops every bus task and destroys the handles
+void      modbus_rtu_bus_mgr_destroy(modbus_rtu_bus_mgr_t *mgr);
+// Takes ownership of a master handle and starts its bus task (worker NULL =
+// defaults). The handle must not have async mode running.
+esp_err_t modbus_rtu_bus_mgr_add_bus(modbus_rtu_bus_mgr_t *mgr, modbus_rtu_t *mb,
+                                     const modbus_rtu_async_config_t *worker, int *out_bus);
+// bus < 0 removes the mapping. Unit 0 is never routed: broadcast with
+// modbus_rtu_bus_mgr_submit_to() on each bus.
+esp_err_t modbus_rtu_bus_mgr_map_unit(modbus_rtu_bus_mgr_t *mgr, uint8_t unit_id, int bus);
+// Handle serving unit_id, for the blocking API; NULL if unmapped
+modbus_rtu_t *modbus_rtu_bus_mgr_handle(modbus_rtu_bus_mgr_t *mgr, uint8_t unit_id);
+// ESP_ERR_NOT_FOUND if the unit is not mapped
+esp_err_t modbus_rtu_bus_mgr_submit(modbus_rtu_bus_mgr_t *mgr, const modbus_rtu_async_req_t *req, TickType_t wait_ticks);
+esp_err_t modbus_rtu_bus_mgr_submit_to(modbus_rtu_bus_mgr_t *mgr, int bus, const modbus_rtu_async_req_t *req,
+                                       TickType_t wait_ticks);
+// Next result of a request submitted without callback. Results are dropped
+// (and counted) when the queue is full, so bus tasks never block on it.
+esp_err_t modbus_rtu_bus_mgr_get_result(modbus_rtu_bus_mgr_t *mgr, modbus_rtu_bus_result_t *out, TickType_t wait_ticks);
+uint32_t  modbus_rtu_bus_mgr_dropped_results(const modbus_rtu_bus_mgr_t *mgr);
+
+// ------------ Poll scheduler ------------
+// Periodic reads run earliest-deadline-first by a scheduler task. Each
+// item's request is sealed once when added, like a compiled request.
+// Deadlines advance by the period, so the schedule does not drift with
+// transaction time.
+typedef struct modbus_rtu_sched_s modbus_rtu_sched_t;
+
+typedef void (*modbus_rtu_poll_cb_t)(int item_id, esp_err_t err, const modbus_rtu_exception_t *ex,
+                                     const uint8_t *response_pdu, size_t response_pdu_len, void *user);
+
+typedef struct {
+    uint8_t unit_id;
+    uint8_t function;       // 0x01..0x04
+    uint16_t addr;
+    uint16_t qty;
+    uint32_t period_ms;
+    uint8_t priority;       // breaks ties between equal deadlines, higher first
+    modbus_rtu_poll_cb_t callback; // runs in the scheduler task
+    void *user;
+} modbus_rtu_poll_item_t;
+
+typedef struct {
+    int max_items;          // default 32
+    int task_stack;         // default 4096
+    int task_priority;      // default 5
+    bool pin_to_core;
+    int task_core;
+} modbus_rtu_sched_config_t;
+
+typedef struct {
+    uint32_t runs;
+    uint32_t errors;
+    uint32_t missed_deadlines;  // polls that finished after their period window
+    uint32_t wire_time_us;      // expected bus time of one poll
+    int64_t jitter_max_us;      // start time - deadline
+    int64_t jitter_avg_us;
+} modbus_rtu_poll_stats_t;
+
+esp_err_t modbus_rtu_sched_create(modbus_rtu_t *mb, const modbus_rtu_sched_config_t *cfg, modbus_rtu_sched_t **out);
+void      modbus_rtu_sched_destroy(modbus_rtu_sched_t *s);
+esp_err_t modbus_rtu_sched_start(modbus_rtu_sched_t *s);
+esp_err_t modbus_rtu_sched_stop(modbus_rtu_sched_t *s);
+
+// Logs a warning when the schedule needs more than 100 % of the bus
+esp_err_t modbus_rtu_sched_add(modbus_rtu_sched_t *s, const modbus_rtu_poll_item_t *item, int *out_id);
+esp_err_t modbus_rtu_sched_remove(modbus_rtu_sched_t *s, int item_id);
+esp_err_t modbus_rtu_sched_get_stats(modbus_rtu_sched_t *s, int item_id, modbus_rtu_poll_stats_t *out);
+// Sum of wire_time / period over all items, in permille of bus capacity
+esp_err_t modbus_rtu_sched_get_load(modbus_rtu_sched_t *s, uint32_t *out_permille);
+
+// ------------ Read coalescing ------------
+// A plan merges many small reads into the fewest protocol-legal frames
+// (125 registers / 2000 bits), reading across gaps of up to max_gap_* unused
+// addresses, and scatters the data back. Build once, execute repeatedly.
+typedef struct {
+    uint8_t unit_id;
+    modbus_rtu_table_t table;
+    uint16_t addr;
+    uint16_t count;
+    void *dest;                 // uint16_t[count] for registers, uint8_t[count] (0/1) for bits
+
+    // written by modbus_rtu_read_plan_execute()
+    esp_err_t err;
+    modbus_rtu_exception_t ex;
+} modbus_rtu_read_req_t;
+
+typedef struct {
+    uint16_t max_gap_regs;
+    uint16_t max_gap_bits;
+} modbus_rtu_plan_config_t;
+
+typedef struct modbus_rtu_read_plan_s modbus_rtu_read_plan_t;
+
+// reqs must stay valid for the life of the plan
+esp_err_t modbus_rtu_read_plan_build(const modbus_rtu_plan_config_t *cfg,
+                                     modbus_rtu_read_req_t *reqs, size_t req_count,
+                                     modbus_rtu_read_plan_t **out);
+// Returns the first error; every request carries its own err/ex.
+// A merged frame rejected with ILLEGAL DATA ADDRESS (e.g. a gap that is not
+// mapped) is retried as individual reads.
+esp_err_t modbus_rtu_read_plan_execute(modbus_rtu_t *mb, modbus_rtu_read_plan_t *plan);
+size_t    modbus_rtu_read_plan_frame_count(const modbus_rtu_read_plan_t *plan);
+void      modbus_rtu_read_plan_free(modbus_rtu_read_plan_t *plan);
+
+// ------------ Read cache ------------
+// Optional read-through cache for FC03/04 in the master helpers. Reads fully
+// covered by fresh entries return without touching the bus; partial overlaps
+// fetch only the missing span. Every write request sent by this master
+// (helpers, raw transactions, async, broadcast) invalidates the overlapping
+// holding-register entries. Enable/disable while no other task uses the master.
+typedef struct {
+    size_t max_entries;         // default 16, each holds up to 125 registers
+    uint32_t default_ttl_ms;    // default 1000
+    size_t max_ttl_rules;       // default 8
+} modbus_rtu_cache_config_t;
+
+typedef struct {
+    uint32_t hits;              // served entirely from the cache
+    uint32_t partial_hits;      // part cached, rest fetched
+    uint32_t misses;
+    uint32_t invalidations;     // entries dropped by writes
+    uint32_t evictions;         // fresh entries dropped for space
+} modbus_rtu_cache_stats_t;
+
+esp_err_t modbus_rtu_master_cache_enable(modbus_rtu_t *mb, const modbus_rtu_cache_config_t *cfg);
+void      modbus_rtu_master_cache_disable(modbus_rtu_t *mb);
+
+// TTL for a register range (table HOLDING or INPUT); unit_id 0 = any unit.
+// ttl_ms 0 keeps the range out of the cache. The shortest matching rule wins.
+esp_err_t modbus_rtu_master_cache_set_ttl(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_table_t table,
+                                         uint16_t addr, uint16_t count, uint32_t ttl_ms);
+
+// unit_id 0 drops everything
+void      modbus_rtu_master_cache_invalidate(modbus_rtu_t *mb, uint8_t unit_id);
+esp_err_t modbus_rtu_master_cache_get_stats(modbus_rtu_t *mb, modbus_rtu_cache_stats_t *out);
+
+// ------------ Adaptive timeouts ------------
+// Per-unit response timeouts from measured turnaround, as TCP does for its
+// retransmission timer: SRTT/RTTVAR smoothing (1/8, 1/4), timeout =
+// SRTT + 4 * RTTVAR plus the wire time of the expected response, clamped to
+// [min_timeout_ms, max_timeout_ms]. Units not heard from yet get the maximum.
+// A timeout doubles the unit's timeout until the next answer. After
+// quarantine_after consecutive timeouts the unit is quarantined: requests
+// fail at once with ESP_ERR_MODBUS_RTU_OFFLINE without using the bus, except
+// one probe per back-off period (doubling up to probe_max_ms). Any answer,
+// exception included, brings the unit back. Enable/disable while no other
+// task uses the master.
+typedef enum {
+    MODBUS_RTU_UNIT_ONLINE = 0,
+    MODBUS_RTU_UNIT_QUARANTINED,
+} modbus_rtu_unit_state_t;
+
+// Called in the requesting task after the bus is released
+typedef void (*modbus_rtu_unit_state_cb_t)(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_unit_state_t state, void *user);
+
+typedef struct {
+    uint32_t min_timeout_ms;        // default 20
+    uint32_t max_timeout_ms;        // default master response_timeout_ms
+    uint32_t quarantine_after;      // consecutive timeouts, default 3
+    uint32_t probe_initial_ms;      // default 1000
+    uint32_t probe_max_ms;          // default 60000
+    modbus_rtu_unit_state_cb_t on_state_change;   // optional
+    void *user;
+} modbus_rtu_adaptive_config_t;
+
+typedef struct {
+    modbus_rtu_unit_state_t state;
+    uint32_t srtt_us;               // smoothed turnaround (end of request to end of response, minus its wire time)
+    uint32_t rttvar_us;
+    uint32_t timeout_ms;            // for a response of unknown length
+    uint32_t consecutive_timeouts;
+    uint32_t next_probe_ms;         // quarantined: time until the next probe
+} modbus_rtu_unit_health_t;
+
+esp_err_t modbus_rtu_master_adaptive_enable(modbus_rtu_t *mb, const modbus_rtu_adaptive_config_t *cfg);
+void      modbus_rtu_master_adaptive_disable(modbus_rtu_t *mb);
+// ESP_ERR_NOT_FOUND if the unit has not been addressed yet
+esp_err_t modbus_rtu_master_unit_health(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_unit_health_t *out);
+// Forgets the unit's estimate and lifts a quarantine
+esp_err_t modbus_rtu_master_unit_reset(modbus_rtu_t *mb, uint8_t unit_id);
+
+// ------------ Statistics ------------
+// Collected when CONFIG_MODBUS_RTU_STATS is set, with lock-free atomic
+// increments, so they can stay on in production. Snapshots can be taken at
+// any time; counters are individually exact but not mutually consistent.
+// Master: latency = end of request to end of response, per target unit.
+// Slave: latency = end of request to end of reply, per served unit.
+#define MODBUS_RTU_LAT_BUCKETS  12  // <=0.5, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000 ms, more
+#define MODBUS_RTU_SIZE_BUCKETS 6   // ADU bytes <=8, 16, 32, 64, 128, more
+
+typedef struct {
+    uint32_t requests;
+    uint32_t responses;         // incl. exception responses
+    uint32_t timeouts;
+    uint32_t crc_errors;
+    uint32_t bad_responses;     // malformed, wrong unit/function, framing
+    uint32_t exceptions[12];    // by exception code; [0] counts codes above 11
+    uint32_t latency_hist[MODBUS_RTU_LAT_BUCKETS];
+} modbus_rtu_unit_stats_t;
+
+typedef struct {
+    modbus_rtu_unit_stats_t total;
+    uint32_t frame_size_hist[MODBUS_RTU_SIZE_BUCKETS];  // TX and RX ADUs
+    uint64_t tx_bytes;
+    uint64_t rx_bytes;
+    uint64_t busy_us;           // wire time of all TX and RX frames
+    uint64_t elapsed_us;        // since create or reset
+    uint32_t bus_util_permille; // busy_us / elapsed_us
+} modbus_rtu_stats_t;
+
+esp_err_t modbus_rtu_get_stats(modbus_rtu_t *mb, modbus_rtu_stats_t *out);
+// ESP_ERR_NOT_FOUND if no traffic for that unit yet
+esp_err_t modbus_rtu_get_unit_stats(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_unit_stats_t *out);
+void      modbus_rtu_reset_stats(modbus_rtu_t *mb);
+
+// ------------ Frame capture ------------
+// Fixed-size ring recording every ADU a handle writes or reads, with a
+// microsecond timestamp (mb_time base, taken when the port call returns),
+// direction and the port result. Recording costs one memcpy per frame and
+// uses only the buffer passed to modbus_rtu_capture_init(); when full the
+// oldest records are overwritten. Frames longer than snap_len are truncated
+// (wire length is kept). RX timeouts with no bytes are not recorded.
+// One ring per handle; export may run while the bus is busy.
+#define MODBUS_RTU_CAPTURE_TX 0
+#define MODBUS_RTU_CAPTURE_RX 1
+
+#define MODBUS_RTU_CAPTURE_HDR_SIZE 16
+// Buffer bytes for `records` frames of up to `snap_len` bytes
+#define MODBUS_RTU_CAPTURE_BUF_SIZE(records, snap_len) \
+    ((size_t)(records) * (MODBUS_RTU_CAPTURE_HDR_SIZE + (((size_t)(snap_len) + 7u) & ~(size_t)7u)))
+
+typedef struct {
+    uint8_t *buf;
+    size_t slot_size;
+    uint32_t slots;
+    uint16_t snap_len;
+    uint8_t role;               // set by attach: 1 master, 2 slave
+    uint32_t head;              // records written since init/clear
+} modbus_rtu_capture_t;
+
+// Called by export with consecutive chunks of the dump
+typedef esp_err_t (*modbus_rtu_capture_write_t)(const void *data, size_t len, void *user);
+
+// snap_len 1..MODBUS_RTU_ADU_MAX; buf must hold at least two records
+esp_err_t modbus_rtu_capture_init(modbus_rtu_capture_t *cap, void *buf, size_t buf_size, uint16_t snap_len);
+// NULL stops capturing on that handle
+esp_err_t modbus_rtu_capture_attach(modbus_rtu_t *mb, modbus_rtu_capture_t *cap);
+// Only while detached
+void      modbus_rtu_capture_clear(modbus_rtu_capture_t *cap);
+// Records currently held (at most the ring size)
+size_t    modbus_rtu_capture_count(const modbus_rtu_capture_t *cap);
+
+// pcap file (LINKTYPE_USER0). Each packet carries an 8-byte pseudo-header
+// { u8 direction, u8 role, u16 wire length, i32 result } (big-endian) then the
+// ADU as captured. Records overwritten during the export are skipped and
+// counted in *out_lost. Decode with tools/mbcap.py.
+esp_err_t modbus_rtu_capture_export_pcap(const modbus_rtu_capture_t *cap, modbus_rtu_capture_write_t write,
+                                         void *user, uint32_t *out_lost);
+
+// ------------ Typed registers ------------
+// Multi-register values decoded from / encoded to the big-endian wire bytes
+// of a register payload in one pass, without a uint16_t array in between.
+// The order names the bytes of a 32-bit value A (most significant) .. D as
+// they appear on the wire; for 64-bit values the same swaps apply to all
+// four registers. 16-bit types only honour the byte swap.
+typedef enum {
+    MODBUS_RTU_ORDER_ABCD = 0,  // big-endian, high register first (Modbus default)
+    MODBUS_RTU_ORDER_CDAB = 1,  // low register first
+    MODBUS_RTU_ORDER_BADC = 2,  // bytes swapped inside each register
+    MODBUS_RTU_ORDER_DCBA = 3,  // little-endian
+} modbus_rtu_word_order_t;
+
+#define MODBUS_RTU_ORDER_WORD_SWAP 0x01
+#define MODBUS_RTU_ORDER_BYTE_SWAP 0x02
+
+typedef enum {
+    MODBUS_RTU_TYPE_U16,
+    MODBUS_RTU_TYPE_I16,
+    MODBUS_RTU_TYPE_U32,
+    MODBUS_RTU_TYPE_I32,
+    MODBUS_RTU_TYPE_F32,
+    MODBUS_RTU_TYPE_U64,
+    MODBUS_RTU_TYPE_I64,
+    MODBUS_RTU_TYPE_F64,
+} modbus_rtu_value_type_t;
+
+typedef struct {
+    modbus_rtu_value_type_t type;
+    modbus_rtu_word_order_t order;
+} modbus_rtu_layout_t;
+
+// Registers per value, 0 for an unknown type
+size_t modbus_rtu_type_regs(modbus_rtu_value_type_t type);
+// count values of layout.type (C array of the matching type) <-> wire bytes.
+// Return the number of wire bytes, 0 on bad arguments.
+size_t modbus_rtu_decode(const uint8_t *wire, size_t count, modbus_rtu_layout_t layout, void *out);
+size_t modbus_rtu_encode(const void *values, size_t count, modbus_rtu_layout_t layout, uint8_t *wire);
+
+// count values from addr of the holding or input table, at most 125
+// registers in total (123 for writes); writes use FC10. Reads go through the
+// read cache when it is enabled.
+esp_err_t modbus_rtu_read_typed(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_table_t table, uint16_t addr,
+                                size_t count, modbus_rtu_layout_t layout, void *out, modbus_rtu_exception_t *ex);
+esp_err_t modbus_rtu_write_typed(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr,
+                                 size_t count, modbus_rtu_layout_t layout, const void *values,
+                                 modbus_rtu_exception_t *ex);
+
 // ------------ Bit helpers ------------
+// One byte per bit (any non-zero byte is a 1) <-> packed bitfield
 size_t modbus_rtu_bits_pack(const uint8_t *src_bits, size_t bit_count, uint8_t *out_bytes, size_t out_len);
 size_t modbus_rtu_bits_unpack(const uint8_t *src_bytes, size_t byte_count, uint8_t *out_bits, size_t out_bits_len);
 
 // ------------ CRC ------------
 uint16_t modbus_rtu_crc16(const uint8_t *data, size_t len);
 
+// Incremental CRC, e.g. while bytes arrive:
+//   uint16_t c = modbus_rtu_crc16_init();
+//   c = modbus_rtu_crc16_update(c, chunk, chunk_len); ...
+//   uint16_t crc = modbus_rtu_crc16_final(c);
+// The engine behind update() is selected by CONFIG_MODBUS_RTU_CRC_*.
+uint16_t modbus_rtu_crc16_init(void);
+uint16_t modbus_rtu_crc16_update(uint16_t crc, const uint8_t *data, size_t len);
+uint16_t modbus_rtu_crc16_final(uint16_t crc);
+
+// Individual engines (same semantics as modbus_rtu_crc16_update)
+uint16_t modbus_rtu_crc16_update_bitwise(uint16_t crc, const uint8_t *data, size_t len); // no table
+uint16_t modbus_rtu_crc16_update_nibble(uint16_t crc, const uint8_t *data, size_t len);  // 32 B table
+uint16_t modbus_rtu_crc16_update_table(uint16_t crc, const uint8_t *data, size_t len);   // 512 B table
+uint16_t modbus_rtu_crc16_update_slice8(uint16_t crc, const uint8_t *data, size_t len);  // 4 KiB table
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,43 @@
+#pragma once
+
+// Stand-ins for the ESP-IDF UART/GPIO types used by modbus_rtu.h when the
+// component is built for the linux target, where the UART driver does not
+// exist. Values match driver/uart.h so configs are portable.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int uart_port_t;
+
+#define UART_NUM_0          0
+#define UART_NUM_1          1
+#define UART_NUM_2          2
+#define UART_PIN_NO_CHANGE  (-1)
+
+typedef enum {
+    UART_DATA_5_BITS = 0x0,
+    UART_DATA_6_BITS = 0x1,
+    UART_DATA_7_BITS = 0x2,
+    UART_DATA_8_BITS = 0x3,
+} uart_word_length_t;
+
+typedef enum {
+    UART_STOP_BITS_1   = 0x1,
+    UART_STOP_BITS_1_5 = 0x2,
+    UART_STOP_BITS_2   = 0x3,
+} uart_stop_bits_t;
+
+typedef enum {
+    UART_PARITY_DISABLE = 0x0,
+    UART_PARITY_EVEN    = 0x2,
+    UART_PARITY_ODD     = 0x3,
+} uart_parity_t;
+
+typedef enum {
+    GPIO_NUM_NC = -1,
+} gpio_num_t;
+
+#ifdef __cplusplus
+}
+#endif
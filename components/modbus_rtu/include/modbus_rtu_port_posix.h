@@ -0,0 +1,40 @@
+#pragma once
+
+// POSIX transport backend (linux target): RTU frames over a pseudo-terminal,
+// a socketpair or any other byte-stream fd, with optional simulated
+// baud-rate pacing so timing resembles a real serial line.
+//
+// Waits (pacing, read_frame) go to vTaskDelay() in whole ticks, so other
+// tasks keep running under the FreeRTOS POSIX simulator; only sub-tick rests
+// block the thread, and a frame's first byte is noticed up to one tick late.
+// Keep master and slave in separate processes for exact gap timing, e.g.
+// fork() after modbus_rtu_posix_socketpair().
+
+#include "modbus_rtu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int fd;         // opened by the caller, not closed by deinit
+    bool pace;      // delay each write by its wire time at the configured baud rate
+
+    // filled in by init
+    uint32_t char_time_us;
+    uint32_t inter_frame_timeout_us;
+    int txrx_turnaround_us;
+} modbus_rtu_posix_port_t;
+
+extern const modbus_rtu_transport_t modbus_rtu_transport_posix;
+
+// Connected pair of stream sockets: fds[0] for one side, fds[1] for the other.
+esp_err_t modbus_rtu_posix_socketpair(int fds[2]);
+
+// Pseudo-terminal in raw mode. The slave side's path (e.g. for an external
+// tool) is written to slave_name if it is not NULL.
+esp_err_t modbus_rtu_posix_openpty(int *master_fd, int *slave_fd, char *slave_name, size_t slave_name_len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,61 +1,28 @@
 #include "modbus_rtu_internal.h"
 
-#ifndef CONFIG_MODBUS_RTU_LOG_LEVEL
-#define CONFIG_MODBUS_RTU_LOG_LEVEL 3
-#endif
-
-#if CONFIG_MODBUS_RTU_LOG_LEVEL >= 4
-#define MB_LOGD(...) ESP_LOGD(__VA_ARGS__)
-#else
-#define MB_LOGD(...)
-#endif
-#if CONFIG_MODBUS_RTU_LOG_LEVEL >= 3
-#define MB_LOGI(...) ESP_LOGI(__VA_ARGS__)
-#else
-#define MB_LOGI(...)
-#endif
-#if CONFIG_MODBUS_RTU_LOG_LEVEL >= 2
-#define MB_LOGW(...) ESP_LOGW(__VA_ARGS__)
-#else
-#define MB_LOGW(...)
-#endif
-#if CONFIG_MODBUS_RTU_LOG_LEVEL >= 1
-#define MB_LOGE(...) ESP_LOGE(__VA_ARGS__)
-#else
-#define MB_LOGE(...)
-#endif
-
 static const char *TAG = "modbus_rtu";
 
 static inline void put_u16_be(uint8_t *p, uint16_t v) { p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)(v & 0xFF); }
 static inline uint16_t get_u16_be(const uint8_t *p) { return (uint16_t)((p[0] << 8) | p[1]); }
 
-static esp_err_t mb_build_adu(uint8_t unit_id, const uint8_t *pdu, size_t pdu_len,
-                             uint8_t *adu, size_t adu_max, size_t *adu_len)
+void mb_frame_seal(modbus_rtu_frame_t *f, uint8_t unit_id, size_t pdu_len)
 {
-    if (!pdu || !adu || !adu_len) return ESP_ERR_INVALID_ARG;
-    if (pdu_len + 1 + 2 > adu_max) return ESP_ERR_NO_MEM;
-
-    adu[0] = unit_id;
-    memcpy(&adu[1], pdu, pdu_len);
-
-    uint16_t crc = modbus_rtu_crc16(adu, 1 + pdu_len);
-    adu[1 + pdu_len + 0] = (uint8_t)(crc & 0xFF); // CRC Lo
-    adu[1 + pdu_len + 1] = (uint8_t)(crc >> 8);   // CRC Hi
-    *adu_len = 1 + pdu_len + 2;
-    return ESP_OK;
+    f->adu[0] = unit_id;
+    uint16_t crc = modbus_rtu_crc16(f->adu, 1 + pdu_len);
+    f->adu[1 + pdu_len + 0] = (uint8_t)(crc & 0xFF); // CRC Lo
+    f->adu[1 + pdu_len + 1] = (uint8_t)(crc >> 8);   // CRC Hi
+    f->adu_len = 1 + pdu_len + 2;
 }
 
-static esp_err_t mb_parse_and_validate_adu(const uint8_t *adu, size_t adu_len,
-                                          uint8_t expected_unit_id,
-                                          const uint8_t *req_pdu, size_t req_pdu_len,
-                                          const modbus_rtu_master_config_t *mcfg,
-                                          uint8_t *out_unit_id,
-                                          uint8_t *out_pdu, size_t out_pdu_max, size_t *out_pdu_len,
-                                          modbus_rtu_exception_t *ex)
+// Validates a received response and returns a view of its PDU
+static esp_err_t mb_check_response(const modbus_rtu_frame_t *f, uint8_t expected_unit_id, uint8_t req_fc,
+                                   const modbus_rtu_master_config_t *mcfg,
+                                   const uint8_t **out_pdu, size_t *out_pdu_len,
+                                   modbus_rtu_exception_t *ex)
 {
-    if (!adu || adu_len < 5 || !out_unit_id || !out_pdu || !out_pdu_len) return ESP_ERR_INVALID_ARG;
-    *out_pdu_len = 0;
+    const uint8_t *adu = f->adu;
+    size_t adu_len = f->adu_len;
+    if (adu_len < 5) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
 
     uint16_t got = (uint16_t)(adu[adu_len - 2] | (adu[adu_len - 1] << 8));
     uint16_t calc = modbus_rtu_crc16(adu, adu_len - 2);
@@ -65,21 +32,132 @@ static esp_err_t mb_parse_and_validate_adu(const uint8_t *adu, size_t adu_len,
     uint8_t fc = adu[1];
 
     if (mcfg && mcfg->strict_unit_id && unit_id != expected_unit_id) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
-    if (mcfg && mcfg->strict_function && req_pdu && req_pdu_len >= 1) {
-        if ((fc & 0x7F) != req_pdu[0]) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
-    }
+    if (mcfg && mcfg->strict_function && (fc & 0x7F) != req_fc) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
 
     if (fc & 0x80) {
         if (ex) { ex->function = (uint8_t)(fc & 0x7F); ex->exception_code = adu[2]; }
         return ESP_ERR_MODBUS_RTU_EXCEPTION;
     }
 
-    size_t pdu_len = adu_len - 1 - 2;
-    if (pdu_len > out_pdu_max) return ESP_ERR_NO_MEM;
+    *out_pdu = &adu[1];
+    *out_pdu_len = adu_len - 1 - 2;
+    return ESP_OK;
+}
+
+size_t mb_expected_rsp_len(const uint8_t *pdu, size_t pdu_len)
+{
+    if (pdu_len < 5) return 0;
+    uint16_t qty = get_u16_be(&pdu[3]);
+    switch (pdu[0]) {
+        case MB_FC_READ_COILS:
+        case MB_FC_READ_DISCRETE_INPUTS:
+            return 5u + (qty + 7u) / 8u;
+        case MB_FC_READ_HOLDING_REGS:
+        case MB_FC_READ_INPUT_REGS:
+        case MB_FC_READWRITE_MULTIPLE_REGS:
+            return 5u + 2u * qty;
+        case MB_FC_WRITE_SINGLE_COIL:
+        case MB_FC_WRITE_SINGLE_REG:
+        case MB_FC_WRITE_MULTIPLE_COILS:
+        case MB_FC_WRITE_MULTIPLE_REGS:
+            return 8;
+        case MB_FC_MASK_WRITE_REG:
+            return 10;
+        default:
+            return 0;
+    }
+}
+
+// Response length from its header, for ending the read on the last CRC
+// byte. arg is the request function code. Anything unexpected is left to
+// the idle gap.
+static size_t mb_predict_response_len(const uint8_t *adu, size_t len, void *arg)
+{
+    uint8_t req_fc = (uint8_t)(uintptr_t)arg;
+    if (len < 2) return 0;
+    if (adu[1] == (req_fc | 0x80)) return 5;
+    if (adu[1] != req_fc) return 0;
+    switch (req_fc) {
+        case MB_FC_READ_COILS:
+        case MB_FC_READ_DISCRETE_INPUTS:
+        case MB_FC_READ_HOLDING_REGS:
+        case MB_FC_READ_INPUT_REGS:
+        case MB_FC_READWRITE_MULTIPLE_REGS:
+            return (len < 3) ? 0 : 5u + adu[2];
+        case MB_FC_WRITE_SINGLE_COIL:
+        case MB_FC_WRITE_SINGLE_REG:
+        case MB_FC_WRITE_MULTIPLE_COILS:
+        case MB_FC_WRITE_MULTIPLE_REGS:
+            return 8;
+        case MB_FC_MASK_WRITE_REG:
+            return 10;
+        default:
+            return 0;
+    }
+}
+
+_Static_assert(sizeof(modbus_rtu_t) <= MODBUS_RTU_HANDLE_SIZE, "MODBUS_RTU_HANDLE_SIZE too small");
+
+// Shared by the heap and static constructors; mb is zeroed, master_mutex set
+#if !CONFIG_IDF_TARGET_LINUX
+static void mb_idle_timer_cb(void *arg)
+{
+    xSemaphoreGive(((modbus_rtu_t*)arg)->idle_sem);
+}
+
+static esp_err_t mb_idle_timer_init(modbus_rtu_t *mb, StaticSemaphore_t *sem_buf)
+{
+    mb->idle_sem = sem_buf ? xSemaphoreCreateBinaryStatic(sem_buf) : xSemaphoreCreateBinary();
+    if (!mb->idle_sem) return ESP_ERR_NO_MEM;
+    const esp_timer_create_args_t args = { .callback = mb_idle_timer_cb, .arg = mb, .name = "mb_idle" };
+    esp_err_t err = esp_timer_create(&args, &mb->idle_timer);
+    if (err != ESP_OK) {
+        vSemaphoreDelete(mb->idle_sem);
+        mb->idle_sem = NULL;
+    }
+    return err;
+}
+
+static void mb_idle_timer_deinit(modbus_rtu_t *mb)
+{
+    if (mb->idle_timer) {
+        esp_timer_stop(mb->idle_timer);
+        esp_timer_delete(mb->idle_timer);
+    }
+    if (mb->idle_sem) vSemaphoreDelete(mb->idle_sem);
+}
+#endif
+
+// idle_buf: storage for the bus-idle semaphore, NULL = heap
+static esp_err_t mb_master_init(modbus_rtu_t *mb, const modbus_rtu_uart_config_t *uart_cfg,
+                                const modbus_rtu_master_config_t *master_cfg, StaticSemaphore_t *idle_buf)
+{
+    mb->role = MB_ROLE_MASTER;
+    mb->master_cfg = *master_cfg;
 
-    memcpy(out_pdu, &adu[1], pdu_len);
-    *out_pdu_len = pdu_len;
-    *out_unit_id = unit_id;
+    if (mb->master_cfg.response_timeout_ms <= 0) mb->master_cfg.response_timeout_ms = 200;
+    if (mb->master_cfg.inter_frame_timeout_us < 0) mb->master_cfg.inter_frame_timeout_us = 0;
+    if (mb->master_cfg.txrx_turnaround_us < 0) mb->master_cfg.txrx_turnaround_us = 0;
+    if (mb->master_cfg.broadcast_turnaround_ms == 0) mb->master_cfg.broadcast_turnaround_ms = 100;
+    if (mb->master_cfg.broadcast_turnaround_ms < 0) mb->master_cfg.broadcast_turnaround_ms = 0;
+
+#if !CONFIG_IDF_TARGET_LINUX
+    esp_err_t err = mb_idle_timer_init(mb, idle_buf);
+    if (err != ESP_OK) return err;
+#else
+    (void)idle_buf;
+    esp_err_t err;
+#endif
+    err = mb_port_init(&mb->port, uart_cfg, mb->master_cfg.inter_frame_timeout_us,
+                       mb->master_cfg.txrx_turnaround_us, mb->master_cfg.enforce_t15);
+    if (err != ESP_OK) {
+#if !CONFIG_IDF_TARGET_LINUX
+        mb_idle_timer_deinit(mb);
+#endif
+        return err;
+    }
+    mb->master_cfg.inter_frame_timeout_us = mb->port.inter_frame_timeout_us;
+    mb_stats_init(mb);
     return ESP_OK;
 }
 
@@ -93,61 +171,339 @@ esp_err_t modbus_rtu_master_create(const modbus_rtu_uart_config_t *uart_cfg,
     modbus_rtu_t *mb = (modbus_rtu_t*)calloc(1, sizeof(modbus_rtu_t));
     if (!mb) return ESP_ERR_NO_MEM;
 
-    mb->role = MB_ROLE_MASTER;
-    mb->master_cfg = *master_cfg;
+    mb->master_mutex = xSemaphoreCreateMutex();
+    mb->async_lock = xSemaphoreCreateMutex();
+    esp_err_t err = (mb->master_mutex && mb->async_lock) ? mb_master_init(mb, uart_cfg, master_cfg, NULL)
+                                                         : ESP_ERR_NO_MEM;
+    if (err != ESP_OK) {
+        if (mb->master_mutex) vSemaphoreDelete(mb->master_mutex);
+    if (mb->async_lock) vSemaphoreDelete(mb->async_lock);
+        if (mb->async_lock) vSemaphoreDelete(mb->async_lock);
+        free(mb);
+        return err;
+    }
 
-    if (mb->master_cfg.response_timeout_ms <= 0) mb->master_cfg.response_timeout_ms = 200;
-    if (mb->master_cfg.inter_frame_timeout_us <= 0) mb->master_cfg.inter_frame_timeout_us = 2000;
-    if (mb->master_cfg.txrx_turnaround_us < 0) mb->master_cfg.txrx_turnaround_us = 0;
+    *out = mb;
+    return ESP_OK;
+}
 
-    mb->master_mutex = xSemaphoreCreateMutex();
-    if (!mb->master_mutex) { free(mb); return ESP_ERR_NO_MEM; }
+esp_err_t modbus_rtu_master_create_static(const modbus_rtu_uart_config_t *uart_cfg,
+                                         const modbus_rtu_master_config_t *master_cfg,
+                                         modbus_rtu_master_static_t *storage,
+                                         modbus_rtu_t **out)
+{
+    if (!uart_cfg || !master_cfg || !storage || !out) return ESP_ERR_INVALID_ARG;
+    *out = NULL;
 
-    esp_err_t err = mb_port_init(&mb->port, uart_cfg, mb->master_cfg.inter_frame_timeout_us,
-                                mb->master_cfg.txrx_turnaround_us);
-    if (err != ESP_OK) { vSemaphoreDelete(mb->master_mutex); free(mb); return err; }
+    modbus_rtu_t *mb = (modbus_rtu_t*)storage->handle.bytes;
+    memset(mb, 0, sizeof(*mb));
+    mb->static_alloc = true;
+    mb->master_mutex = xSemaphoreCreateMutexStatic(&storage->mutex);
+    mb->async_lock = xSemaphoreCreateMutexStatic(&storage->async_lock);
+    if (!mb->master_mutex || !mb->async_lock) return ESP_ERR_INVALID_STATE;
+
+    esp_err_t err = mb_master_init(mb, uart_cfg, master_cfg, &storage->idle);
+    if (err != ESP_OK) {
+        vSemaphoreDelete(mb->master_mutex);
+        vSemaphoreDelete(mb->async_lock);
+        return err;
+    }
 
     *out = mb;
     return ESP_OK;
 }
 
+static esp_err_t mb_unit_check(const modbus_rtu_slave_cb_t *callbacks, const modbus_rtu_data_model_t *data_model)
+{
+    if (!callbacks && !data_model) return ESP_ERR_INVALID_ARG;
+    if (mb_model_validate(data_model) != ESP_OK) return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+static void mb_unit_set(mb_unit_t *u, const modbus_rtu_slave_cb_t *callbacks,
+                        const modbus_rtu_data_model_t *data_model, void *user_ctx)
+{
+    if (callbacks) u->cb = *callbacks;
+    u->model = data_model;
+    u->user_ctx = user_ctx;
+}
+
+static esp_err_t mb_unit_alloc(const modbus_rtu_slave_cb_t *callbacks, const modbus_rtu_data_model_t *data_model,
+                               void *user_ctx, mb_unit_t **out)
+{
+    esp_err_t err = mb_unit_check(callbacks, data_model);
+    if (err != ESP_OK) return err;
+
+    mb_unit_t *u = (mb_unit_t*)calloc(1, sizeof(mb_unit_t));
+    if (!u) return ESP_ERR_NO_MEM;
+    mb_unit_set(u, callbacks, data_model, user_ctx);
+    *out = u;
+    return ESP_OK;
+}
+
+// False for the default unit of a static slave, which lives in the handle
+static bool mb_unit_owned(const modbus_rtu_t *mb, const mb_unit_t *u)
+{
+    return u != &mb->static_unit;
+}
+
+// Shared by the heap and static constructors; mb is zeroed, units_lock set
+static esp_err_t mb_slave_init(modbus_rtu_t *mb, const modbus_rtu_uart_config_t *uart_cfg,
+                               const modbus_rtu_slave_config_t *slave_cfg, mb_unit_t *u)
+{
+    mb->role = MB_ROLE_SLAVE;
+    mb->slave_cfg = *slave_cfg;
+    if (mb->slave_cfg.inter_frame_timeout_us < 0) mb->slave_cfg.inter_frame_timeout_us = 0;
+    if (mb->slave_cfg.rx_poll_delay_ms <= 0) mb->slave_cfg.rx_poll_delay_ms = 1;
+    if (mb->slave_cfg.max_adu_size == 0) mb->slave_cfg.max_adu_size = MB_ADU_MAX_DEFAULT;
+
+    esp_err_t err = mb_port_init(&mb->port, uart_cfg, mb->slave_cfg.inter_frame_timeout_us,
+                                mb->slave_cfg.txrx_turnaround_us, mb->slave_cfg.enforce_t15);
+    if (err != ESP_OK) return err;
+    mb->units[slave_cfg->unit_id] = u;
+    mb->slave_cfg.inter_frame_timeout_us = mb->port.inter_frame_timeout_us;
+    mb_stats_init(mb);
+    return ESP_OK;
+}
+
 esp_err_t modbus_rtu_slave_create(const modbus_rtu_uart_config_t *uart_cfg,
                                  const modbus_rtu_slave_config_t *slave_cfg,
                                  const modbus_rtu_slave_cb_t *callbacks,
                                  void *user_ctx,
                                  modbus_rtu_t **out)
 {
-    if (!uart_cfg || !slave_cfg || !callbacks || !out) return ESP_ERR_INVALID_ARG;
-    if (slave_cfg->unit_id == 0 || slave_cfg->unit_id > 247) return ESP_ERR_INVALID_ARG;
+    if (!uart_cfg || !slave_cfg || !out) return ESP_ERR_INVALID_ARG;
+    if (slave_cfg->unit_id > 247) return ESP_ERR_INVALID_ARG;
 
     *out = NULL;
+    mb_unit_t *u = NULL;
+    if (slave_cfg->unit_id != 0) {
+        esp_err_t err = mb_unit_alloc(callbacks, slave_cfg->data_model, user_ctx, &u);
+        if (err != ESP_OK) return err;
+    }
+
     modbus_rtu_t *mb = (modbus_rtu_t*)calloc(1, sizeof(modbus_rtu_t));
-    if (!mb) return ESP_ERR_NO_MEM;
+    if (!mb) { free(u); return ESP_ERR_NO_MEM; }
 
-    mb->role = MB_ROLE_SLAVE;
-    mb->slave_cfg = *slave_cfg;
-    if (mb->slave_cfg.inter_frame_timeout_us <= 0) mb->slave_cfg.inter_frame_timeout_us = 2000;
-    if (mb->slave_cfg.rx_poll_delay_ms <= 0) mb->slave_cfg.rx_poll_delay_ms = 1;
-    if (mb->slave_cfg.max_adu_size == 0) mb->slave_cfg.max_adu_size = MB_ADU_MAX_DEFAULT;
+    mb->units_lock = xSemaphoreCreateMutex();
+    if (!mb->units_lock) { free(u); free(mb); return ESP_ERR_NO_MEM; }
 
-    mb->cb = *callbacks;
-    mb->user_ctx = user_ctx;
+    esp_err_t err = mb_slave_init(mb, uart_cfg, slave_cfg, u);
+    if (err != ESP_OK) { vSemaphoreDelete(mb->units_lock); free(u); free(mb); return err; }
 
-    esp_err_t err = mb_port_init(&mb->port, uart_cfg, mb->slave_cfg.inter_frame_timeout_us,
-                                mb->slave_cfg.txrx_turnaround_us);
-    if (err != ESP_OK) { free(mb); return err; }
+    *out = mb;
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_slave_create_static(const modbus_rtu_uart_config_t *uart_cfg,
+                                        const modbus_rtu_slave_config_t *slave_cfg,
+                                        const modbus_rtu_slave_cb_t *callbacks,
+                                        void *user_ctx,
+                                        modbus_rtu_slave_static_t *storage,
+                                        modbus_rtu_t **out)
+{
+    if (!uart_cfg || !slave_cfg || !storage || !out) return ESP_ERR_INVALID_ARG;
+    if (slave_cfg->unit_id > 247) return ESP_ERR_INVALID_ARG;
+    if (slave_cfg->max_adu_size > sizeof(storage->rx)) return ESP_ERR_INVALID_SIZE;
+
+    *out = NULL;
+    if (slave_cfg->unit_id != 0) {
+        esp_err_t err = mb_unit_check(callbacks, slave_cfg->data_model);
+        if (err != ESP_OK) return err;
+    }
+
+    modbus_rtu_t *mb = (modbus_rtu_t*)storage->handle.bytes;
+    memset(mb, 0, sizeof(*mb));
+    mb->static_alloc = true;
+    mb->slave_static = storage;
+    mb_unit_t *u = NULL;
+    if (slave_cfg->unit_id != 0) {
+        u = &mb->static_unit;
+        mb_unit_set(u, callbacks, slave_cfg->data_model, user_ctx);
+    }
+
+    mb->units_lock = xSemaphoreCreateMutexStatic(&storage->mutex);
+    if (!mb->units_lock) return ESP_ERR_INVALID_STATE;
+
+    esp_err_t err = mb_slave_init(mb, uart_cfg, slave_cfg, u);
+    if (err != ESP_OK) { vSemaphoreDelete(mb->units_lock); return err; }
 
     *out = mb;
     return ESP_OK;
 }
 
+esp_err_t modbus_rtu_slave_add_unit(modbus_rtu_t *mb, uint8_t unit_id,
+                                   const modbus_rtu_slave_cb_t *callbacks,
+                                   const modbus_rtu_data_model_t *data_model,
+                                   void *user_ctx)
+{
+    if (!mb || mb->role != MB_ROLE_SLAVE) return ESP_ERR_INVALID_STATE;
+    if (unit_id == 0 || unit_id > 247) return ESP_ERR_INVALID_ARG;
+
+    mb_unit_t *u = NULL;
+    esp_err_t err = mb_unit_alloc(callbacks, data_model, user_ctx, &u);
+    if (err != ESP_OK) return err;
+
+    xSemaphoreTake(mb->units_lock, portMAX_DELAY);
+    if (mb->units[unit_id]) err = ESP_ERR_INVALID_STATE;
+    else mb->units[unit_id] = u;
+    xSemaphoreGive(mb->units_lock);
+
+    if (err != ESP_OK) free(u);
+    return err;
+}
+
+esp_err_t modbus_rtu_slave_remove_unit(modbus_rtu_t *mb, uint8_t unit_id)
+{
+    if (!mb || mb->role != MB_ROLE_SLAVE) return ESP_ERR_INVALID_STATE;
+    if (unit_id == 0 || unit_id > 247) return ESP_ERR_INVALID_ARG;
+
+    // Waits for a request in progress on this slave to finish
+    xSemaphoreTake(mb->units_lock, portMAX_DELAY);
+    mb_unit_t *u = mb->units[unit_id];
+    mb->units[unit_id] = NULL;
+    xSemaphoreGive(mb->units_lock);
+
+    if (!u) return ESP_ERR_NOT_FOUND;
+    if (mb_unit_owned(mb, u)) free(u);
+    return ESP_OK;
+}
+
 void modbus_rtu_destroy(modbus_rtu_t *mb)
 {
     if (!mb) return;
     if (mb->role == MB_ROLE_SLAVE) modbus_rtu_slave_stop(mb);
+    if (mb->async) modbus_rtu_master_async_stop(mb);
+    if (mb->cache) modbus_rtu_master_cache_disable(mb);
+    if (mb->adapt) modbus_rtu_master_adaptive_disable(mb);
     if (mb->master_mutex) vSemaphoreDelete(mb->master_mutex);
+    if (mb->async_lock) vSemaphoreDelete(mb->async_lock);
+#if !CONFIG_IDF_TARGET_LINUX
+    if (mb->role == MB_ROLE_MASTER) mb_idle_timer_deinit(mb);
+#endif
+    if (mb->units_lock) vSemaphoreDelete(mb->units_lock);
+    for (int i = 0; i < 256; ++i) {
+        if (mb_unit_owned(mb, mb->units[i])) free(mb->units[i]);
+    }
+    mb_stats_free(mb);
     mb_port_deinit(&mb->port);
-    free(mb);
+    if (!mb->static_alloc) free(mb);
+}
+
+// Called with master_mutex held
+static void mb_bus_wait_idle(modbus_rtu_t *mb)
+{
+    // t3.5 after a predicted response end is usually shorter than a tick:
+    // a tick wait would stretch it to a whole tick, spinning costs the CPU
+    const int64_t tick_us = (int64_t)portTICK_PERIOD_MS * 1000;
+    for (;;) {
+        int64_t left_us = mb->bus_idle_at_us - mb_time_us();
+        if (left_us <= 0) return;
+#if !CONFIG_IDF_TARGET_LINUX
+        if (left_us < tick_us) {
+            xSemaphoreTake(mb->idle_sem, 0);    // a give left over from a timed-out wait
+            if (esp_timer_start_once(mb->idle_timer, (uint64_t)left_us) == ESP_OK) {
+                if (xSemaphoreTake(mb->idle_sem, 2) != pdTRUE) esp_timer_stop(mb->idle_timer);
+                continue;
+            }
+        }
+#else
+        // nanosleep() leaves the CPU to other processes
+        if (left_us < tick_us) { mb_delay_us((uint32_t)left_us); return; }
+#endif
+        // Wakes within the tick before the end
+        vTaskDelay(left_us >= tick_us ? (TickType_t)(left_us / tick_us) : 1);
+    }
+}
+
+esp_err_t mb_master_exchange(modbus_rtu_t *mb, const uint8_t *tx, size_t tx_len, size_t rsp_len,
+                             modbus_rtu_frame_t *rx, const uint8_t **response_pdu, size_t *response_pdu_len,
+                             modbus_rtu_exception_t *ex, int *state)
+{
+    uint8_t unit_id = tx[0];
+    uint8_t req_fc = tx[1];
+    size_t pdu_len = tx_len - 3;
+    *state = -1;
+
+    if (mb->cache) mb_cache_invalidate_pdu(mb->cache, unit_id, &tx[1], pdu_len);
+
+    int timeout_ms = mb->master_cfg.response_timeout_ms;
+    if (mb->adapt && unit_id != 0) {
+        esp_err_t err = mb_adapt_begin(mb, unit_id, rsp_len ? rsp_len : mb_expected_rsp_len(&tx[1], pdu_len), &timeout_ms);
+        if (err != ESP_OK) return err;
+    }
+
+    mb_bus_wait_idle(mb);
+    esp_err_t err = mb_port_write_adu(&mb->port, tx, tx_len);
+    if (err != ESP_OK) return err;
+    mb_stats_request(mb, unit_id);
+    mb_stats_frame(mb, tx_len, 0);
+
+    if (unit_id == 0) {
+        // Slaves execute broadcasts silently; give them time before the next frame
+        mb->bus_idle_at_us = mb_time_us() + (int64_t)mb->master_cfg.broadcast_turnaround_ms * 1000;
+        return ESP_OK;
+    }
+
+    // The request is on the wire; tx may be rx->adu, so reading can start now
+    int64_t sent_at = mb_time_us();
+    bool early = false;
+    if (mb->master_cfg.wait_frame_gap || mb->port.enforce_t15) {
+        err = mb_port_read_frame(&mb->port, rx->adu, sizeof(rx->adu), &rx->adu_len, timeout_ms);
+    } else {
+        err = mb_port_read_frame_expect(&mb->port, rx->adu, sizeof(rx->adu), &rx->adu_len, timeout_ms,
+                                        mb_predict_response_len, (void*)(uintptr_t)req_fc, &early);
+    }
+    // The slave may not see our next request before the line was idle for t3.5
+    if (early) mb->bus_idle_at_us = mb_time_us() + mb->port.t35_us;
+    if (err == ESP_OK) {
+        mb_stats_frame(mb, 0, rx->adu_len);
+        err = mb_check_response(rx, unit_id, req_fc, &mb->master_cfg, response_pdu, response_pdu_len, ex);
+        if (err == ESP_OK && rsp_len && rx->adu_len != rsp_len) {
+            *response_pdu = NULL;
+            *response_pdu_len = 0;
+            err = ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+        }
+    }
+    int64_t elapsed_us = mb_time_us() - sent_at;
+    mb_stats_result(mb, unit_id, err, rx->adu[2], elapsed_us);
+    // The estimator assumes reads that end with the idle gap
+    if (early) elapsed_us += mb->port.inter_frame_timeout_us;
+    if (mb->adapt) *state = mb_adapt_end(mb, unit_id, err, rx->adu_len, elapsed_us);
+    return err;
+}
+
+esp_err_t mb_master_run_adu(modbus_rtu_t *mb, const uint8_t *tx, size_t tx_len, size_t rsp_len,
+                            modbus_rtu_frame_t *rx, const uint8_t **response_pdu, size_t *response_pdu_len,
+                            modbus_rtu_exception_t *ex)
+{
+    *response_pdu = NULL;
+    *response_pdu_len = 0;
+    if (ex) { ex->function = 0; ex->exception_code = 0; }
+
+    uint8_t unit_id = tx[0];    // tx may be overwritten by the response
+    if (xSemaphoreTake(mb->master_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) return ESP_ERR_TIMEOUT;
+    int state;
+    esp_err_t err = mb_master_exchange(mb, tx, tx_len, rsp_len, rx, response_pdu, response_pdu_len, ex, &state);
+    xSemaphoreGive(mb->master_mutex);
+
+    if (state >= 0) mb_adapt_notify(mb, unit_id, state);
+    return err;
+}
+
+esp_err_t modbus_rtu_master_transaction_frame(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_frame_t *frame,
+                                             size_t request_pdu_len,
+                                             const uint8_t **response_pdu, size_t *response_pdu_len,
+                                             modbus_rtu_exception_t *ex)
+{
+    if (!mb || mb->role != MB_ROLE_MASTER) return ESP_ERR_INVALID_STATE;
+    if (!frame || request_pdu_len < 1) return ESP_ERR_INVALID_ARG;
+    if (!response_pdu || !response_pdu_len) return ESP_ERR_INVALID_ARG;
+    if (request_pdu_len > MODBUS_RTU_PDU_MAX) return ESP_ERR_NO_MEM;
+
+    mb_frame_seal(frame, unit_id, request_pdu_len);
+    // The response lands in the same buffer
+    return mb_master_run_adu(mb, frame->adu, frame->adu_len, 0, frame, response_pdu, response_pdu_len, ex);
 }
 
 esp_err_t modbus_rtu_master_transaction(modbus_rtu_t *mb, uint8_t unit_id,
@@ -158,83 +514,85 @@ esp_err_t modbus_rtu_master_transaction(modbus_rtu_t *mb, uint8_t unit_id,
     if (!mb || mb->role != MB_ROLE_MASTER) return ESP_ERR_INVALID_STATE;
     if (!request_pdu || request_pdu_len < 1) return ESP_ERR_INVALID_ARG;
     if (!response_pdu || !response_pdu_len) return ESP_ERR_INVALID_ARG;
+    if (request_pdu_len > MODBUS_RTU_PDU_MAX) return ESP_ERR_NO_MEM;
 
     *response_pdu_len = 0;
-    if (ex) { ex->function = 0; ex->exception_code = 0; }
 
-    bool expect_response = (unit_id != 0);
+    modbus_rtu_frame_t f;
+    memcpy(modbus_rtu_frame_pdu(&f), request_pdu, request_pdu_len);
 
-    if (xSemaphoreTake(mb->master_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) return ESP_ERR_TIMEOUT;
-
-    uint8_t adu_tx[MB_ADU_MAX_DEFAULT];
-    size_t adu_tx_len = 0;
-    esp_err_t err = mb_build_adu(unit_id, request_pdu, request_pdu_len, adu_tx, sizeof(adu_tx), &adu_tx_len);
-    if (err != ESP_OK) { xSemaphoreGive(mb->master_mutex); return err; }
-
-    err = mb_port_write_adu(&mb->port, adu_tx, adu_tx_len);
-    if (err != ESP_OK) { xSemaphoreGive(mb->master_mutex); return err; }
-
-    if (!expect_response) { xSemaphoreGive(mb->master_mutex); return ESP_OK; }
+    const uint8_t *rsp = NULL;
+    size_t rsp_len = 0;
+    esp_err_t err = modbus_rtu_master_transaction_frame(mb, unit_id, &f, request_pdu_len, &rsp, &rsp_len, ex);
+    if (err != ESP_OK || !rsp) return err;
+    if (rsp_len > response_pdu_max) return ESP_ERR_NO_MEM;
 
-    uint8_t adu_rx[MB_ADU_MAX_DEFAULT];
-    size_t adu_rx_len = 0;
-    err = mb_port_read_frame(&mb->port, adu_rx, sizeof(adu_rx), &adu_rx_len, mb->master_cfg.response_timeout_ms);
-    if (err != ESP_OK) { xSemaphoreGive(mb->master_mutex); return err; }
+    memcpy(response_pdu, rsp, rsp_len);
+    *response_pdu_len = rsp_len;
+    return ESP_OK;
+}
 
-    uint8_t rx_unit = 0;
-    size_t pdu_len = 0;
-    err = mb_parse_and_validate_adu(adu_rx, adu_rx_len, unit_id, request_pdu, request_pdu_len,
-                                   &mb->master_cfg, &rx_unit, response_pdu, response_pdu_max, &pdu_len, ex);
-    if (err == ESP_OK) *response_pdu_len = pdu_len;
+// -------- Master helpers --------
+// Requests are encoded straight into a frame and responses decoded from the
+// view into it; the only copy is into the caller's output array.
 
-    xSemaphoreGive(mb->master_mutex);
-    return err;
+// Checks a 5-byte echo response: fc, a, b
+static esp_err_t mb_check_echo(const uint8_t *rsp, size_t rsp_len, uint8_t fc, uint16_t a, uint16_t b)
+{
+    if (!rsp || rsp_len != 5 || rsp[0] != fc) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    if (get_u16_be(&rsp[1]) != a || get_u16_be(&rsp[3]) != b) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    return ESP_OK;
 }
 
-// -------- Master helpers --------
+// packed: out is a bitfield of (qty + 7) / 8 bytes, else one byte per bit
 static esp_err_t mb_read_bits(modbus_rtu_t *mb, uint8_t unit_id, uint8_t fc, uint16_t addr, uint16_t qty,
-                             uint8_t *out_bits, size_t out_bits_len, modbus_rtu_exception_t *ex)
+                             uint8_t *out, size_t out_len, bool packed, modbus_rtu_exception_t *ex)
 {
-    if (!out_bits) return ESP_ERR_INVALID_ARG;
+    if (!out) return ESP_ERR_INVALID_ARG;
+    if (unit_id == 0) return ESP_ERR_INVALID_ARG;    // reads cannot be broadcast
     if (qty < 1 || qty > 2000) return ESP_ERR_INVALID_ARG;
-    if (out_bits_len < qty) return ESP_ERR_INVALID_SIZE;
+    size_t byte_count = (qty + 7u) / 8u;
+    if (out_len < (packed ? byte_count : qty)) return ESP_ERR_INVALID_SIZE;
 
-    uint8_t req[5];
+    modbus_rtu_frame_t f;
+    uint8_t *req = modbus_rtu_frame_pdu(&f);
     req[0] = fc;
     put_u16_be(&req[1], addr);
     put_u16_be(&req[3], qty);
 
-    uint8_t rsp[MB_ADU_MAX_DEFAULT];
+    const uint8_t *rsp = NULL;
     size_t rsp_len = 0;
-    esp_err_t err = modbus_rtu_master_transaction(mb, unit_id, req, sizeof(req), rsp, sizeof(rsp), &rsp_len, ex);
+    esp_err_t err = modbus_rtu_master_transaction_frame(mb, unit_id, &f, 5, &rsp, &rsp_len, ex);
     if (err != ESP_OK) return err;
 
-    if (rsp_len < 2 || rsp[0] != fc) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
-    uint8_t byte_count = rsp[1];
-    if (rsp_len != (size_t)(2 + byte_count)) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    if (!rsp || rsp_len < 2 || rsp[0] != fc) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    if (rsp[1] != byte_count || rsp_len != 2 + byte_count) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
 
-    modbus_rtu_bits_unpack(&rsp[2], byte_count, out_bits, out_bits_len);
+    if (packed) {
+        memcpy(out, &rsp[2], byte_count);
+        if (qty % 8) out[byte_count - 1] &= (uint8_t)((1u << (qty % 8)) - 1);
+    } else {
+        modbus_rtu_bits_unpack(&rsp[2], byte_count, out, qty);
+    }
     return ESP_OK;
 }
 
-static esp_err_t mb_read_regs(modbus_rtu_t *mb, uint8_t unit_id, uint8_t fc, uint16_t addr, uint16_t qty,
-                             uint16_t *out_regs, size_t out_regs_len, modbus_rtu_exception_t *ex)
+// Arguments already checked by the caller
+esp_err_t mb_master_fetch_regs(modbus_rtu_t *mb, uint8_t unit_id, uint8_t fc, uint16_t addr, uint16_t qty,
+                               uint16_t *out_regs, modbus_rtu_exception_t *ex)
 {
-    if (!out_regs) return ESP_ERR_INVALID_ARG;
-    if (qty < 1 || qty > 125) return ESP_ERR_INVALID_ARG;
-    if (out_regs_len < qty) return ESP_ERR_INVALID_SIZE;
-
-    uint8_t req[5];
+    modbus_rtu_frame_t f;
+    uint8_t *req = modbus_rtu_frame_pdu(&f);
     req[0] = fc;
     put_u16_be(&req[1], addr);
     put_u16_be(&req[3], qty);
 
-    uint8_t rsp[MB_ADU_MAX_DEFAULT];
+    const uint8_t *rsp = NULL;
     size_t rsp_len = 0;
-    esp_err_t err = modbus_rtu_master_transaction(mb, unit_id, req, sizeof(req), rsp, sizeof(rsp), &rsp_len, ex);
+    esp_err_t err = modbus_rtu_master_transaction_frame(mb, unit_id, &f, 5, &rsp, &rsp_len, ex);
     if (err != ESP_OK) return err;
 
-    if (rsp_len < 2 || rsp[0] != fc) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    if (!rsp || rsp_len < 2 || rsp[0] != fc) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
     uint8_t byte_count = rsp[1];
     if (byte_count != (uint8_t)(qty * 2)) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
     if (rsp_len != (size_t)(2 + byte_count)) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
@@ -243,16 +601,40 @@ static esp_err_t mb_read_regs(modbus_rtu_t *mb, uint8_t unit_id, uint8_t fc, uin
     return ESP_OK;
 }
 
+static esp_err_t mb_read_regs(modbus_rtu_t *mb, uint8_t unit_id, uint8_t fc, uint16_t addr, uint16_t qty,
+                             uint16_t *out_regs, size_t out_regs_len, modbus_rtu_exception_t *ex)
+{
+    if (!out_regs) return ESP_ERR_INVALID_ARG;
+    if (unit_id == 0) return ESP_ERR_INVALID_ARG;    // reads cannot be broadcast
+    if (qty < 1 || qty > 125) return ESP_ERR_INVALID_ARG;
+    if (out_regs_len < qty) return ESP_ERR_INVALID_SIZE;
+
+    if (mb->cache) return mb_cache_read_regs(mb, unit_id, fc, addr, qty, out_regs, ex);
+    return mb_master_fetch_regs(mb, unit_id, fc, addr, qty, out_regs, ex);
+}
+
 esp_err_t modbus_rtu_read_coils(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
                                uint8_t *out_bits, size_t out_bits_len, modbus_rtu_exception_t *ex)
 {
-    return mb_read_bits(mb, unit_id, MB_FC_READ_COILS, addr, qty, out_bits, out_bits_len, ex);
+    return mb_read_bits(mb, unit_id, MB_FC_READ_COILS, addr, qty, out_bits, out_bits_len, false, ex);
+}
+
+esp_err_t modbus_rtu_read_coils_packed(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
+                                      uint8_t *out_bytes, size_t out_bytes_len, modbus_rtu_exception_t *ex)
+{
+    return mb_read_bits(mb, unit_id, MB_FC_READ_COILS, addr, qty, out_bytes, out_bytes_len, true, ex);
 }
 
 esp_err_t modbus_rtu_read_discrete_inputs(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
                                          uint8_t *out_bits, size_t out_bits_len, modbus_rtu_exception_t *ex)
 {
-    return mb_read_bits(mb, unit_id, MB_FC_READ_DISCRETE_INPUTS, addr, qty, out_bits, out_bits_len, ex);
+    return mb_read_bits(mb, unit_id, MB_FC_READ_DISCRETE_INPUTS, addr, qty, out_bits, out_bits_len, false, ex);
+}
+
+esp_err_t modbus_rtu_read_discrete_inputs_packed(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
+                                                uint8_t *out_bytes, size_t out_bytes_len, modbus_rtu_exception_t *ex)
+{
+    return mb_read_bits(mb, unit_id, MB_FC_READ_DISCRETE_INPUTS, addr, qty, out_bytes, out_bytes_len, true, ex);
 }
 
 esp_err_t modbus_rtu_read_holding_registers(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
@@ -267,67 +649,75 @@ esp_err_t modbus_rtu_read_input_registers(modbus_rtu_t *mb, uint8_t unit_id, uin
     return mb_read_regs(mb, unit_id, MB_FC_READ_INPUT_REGS, addr, qty, out_regs, out_regs_len, ex);
 }
 
-esp_err_t modbus_rtu_write_single_coil(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, bool on,
-                                      modbus_rtu_exception_t *ex)
+// FC05/FC06: 5-byte request echoed back
+static esp_err_t mb_write_single(modbus_rtu_t *mb, uint8_t unit_id, uint8_t fc, uint16_t addr, uint16_t value,
+                                 modbus_rtu_exception_t *ex)
 {
-    uint8_t req[5];
-    req[0] = MB_FC_WRITE_SINGLE_COIL;
+    modbus_rtu_frame_t f;
+    uint8_t *req = modbus_rtu_frame_pdu(&f);
+    req[0] = fc;
     put_u16_be(&req[1], addr);
-    put_u16_be(&req[3], on ? 0xFF00 : 0x0000);
+    put_u16_be(&req[3], value);
 
-    uint8_t rsp[16];
+    const uint8_t *rsp = NULL;
     size_t rsp_len = 0;
-    esp_err_t err = modbus_rtu_master_transaction(mb, unit_id, req, sizeof(req), rsp, sizeof(rsp), &rsp_len, ex);
-    if (err != ESP_OK) return err;
+    esp_err_t err = modbus_rtu_master_transaction_frame(mb, unit_id, &f, 5, &rsp, &rsp_len, ex);
+    if (err != ESP_OK || unit_id == 0) return err;
+    return mb_check_echo(rsp, rsp_len, fc, addr, value);
+}
 
-    if (rsp_len != sizeof(req) || memcmp(rsp, req, sizeof(req)) != 0) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
-    return ESP_OK;
+esp_err_t modbus_rtu_write_single_coil(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, bool on,
+                                      modbus_rtu_exception_t *ex)
+{
+    return mb_write_single(mb, unit_id, MB_FC_WRITE_SINGLE_COIL, addr, on ? 0xFF00 : 0x0000, ex);
 }
 
 esp_err_t modbus_rtu_write_single_register(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t value,
                                           modbus_rtu_exception_t *ex)
 {
-    uint8_t req[5];
-    req[0] = MB_FC_WRITE_SINGLE_REG;
-    put_u16_be(&req[1], addr);
-    put_u16_be(&req[3], value);
-
-    uint8_t rsp[16];
-    size_t rsp_len = 0;
-    esp_err_t err = modbus_rtu_master_transaction(mb, unit_id, req, sizeof(req), rsp, sizeof(rsp), &rsp_len, ex);
-    if (err != ESP_OK) return err;
-
-    if (rsp_len != sizeof(req) || memcmp(rsp, req, sizeof(req)) != 0) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
-    return ESP_OK;
+    return mb_write_single(mb, unit_id, MB_FC_WRITE_SINGLE_REG, addr, value, ex);
 }
 
-esp_err_t modbus_rtu_write_multiple_coils(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
-                                         const uint8_t *bits, size_t bits_len, modbus_rtu_exception_t *ex)
+// packed: src is a bitfield of (qty + 7) / 8 bytes, else one byte per bit
+static esp_err_t mb_write_coils(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
+                                const uint8_t *src, size_t src_len, bool packed, modbus_rtu_exception_t *ex)
 {
-    if (!bits) return ESP_ERR_INVALID_ARG;
+    if (!src) return ESP_ERR_INVALID_ARG;
     if (qty < 1 || qty > 1968) return ESP_ERR_INVALID_ARG;
-    if (bits_len < qty) return ESP_ERR_INVALID_SIZE;
-
-    uint8_t packed[256];
-    size_t byte_count = modbus_rtu_bits_pack(bits, qty, packed, sizeof(packed));
-    if (byte_count == 0) return ESP_ERR_INVALID_SIZE;
+    size_t byte_count = (qty + 7u) / 8u;
+    if (src_len < (packed ? byte_count : qty)) return ESP_ERR_INVALID_SIZE;
+
+    modbus_rtu_frame_t f;
+    uint8_t *req = modbus_rtu_frame_pdu(&f);
+    if (packed) {
+        memcpy(&req[6], src, byte_count);
+        if (qty % 8) req[6 + byte_count - 1] &= (uint8_t)((1u << (qty % 8)) - 1);   // unused bits go out as 0
+    } else {
+        modbus_rtu_bits_pack(src, qty, &req[6], MODBUS_RTU_PDU_MAX - 6);
+    }
 
-    size_t req_len = 6 + byte_count;
-    uint8_t req[6 + 256];
     req[0] = MB_FC_WRITE_MULTIPLE_COILS;
     put_u16_be(&req[1], addr);
     put_u16_be(&req[3], qty);
     req[5] = (uint8_t)byte_count;
-    memcpy(&req[6], packed, byte_count);
 
-    uint8_t rsp[16];
+    const uint8_t *rsp = NULL;
     size_t rsp_len = 0;
-    esp_err_t err = modbus_rtu_master_transaction(mb, unit_id, req, req_len, rsp, sizeof(rsp), &rsp_len, ex);
-    if (err != ESP_OK) return err;
+    esp_err_t err = modbus_rtu_master_transaction_frame(mb, unit_id, &f, 6 + byte_count, &rsp, &rsp_len, ex);
+    if (err != ESP_OK || unit_id == 0) return err;
+    return mb_check_echo(rsp, rsp_len, MB_FC_WRITE_MULTIPLE_COILS, addr, qty);
+}
 
-    if (rsp_len != 5 || rsp[0] != MB_FC_WRITE_MULTIPLE_COILS) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
-    if (get_u16_be(&rsp[1]) != addr || get_u16_be(&rsp[3]) != qty) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
-    return ESP_OK;
+esp_err_t modbus_rtu_write_multiple_coils(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
+                                         const uint8_t *bits, size_t bits_len, modbus_rtu_exception_t *ex)
+{
+    return mb_write_coils(mb, unit_id, addr, qty, bits, bits_len, false, ex);
+}
+
+esp_err_t modbus_rtu_write_multiple_coils_packed(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
+                                                const uint8_t *bytes, size_t bytes_len, modbus_rtu_exception_t *ex)
+{
+    return mb_write_coils(mb, unit_id, addr, qty, bytes, bytes_len, true, ex);
 }
 
 esp_err_t modbus_rtu_write_multiple_registers(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
@@ -338,41 +728,41 @@ esp_err_t modbus_rtu_write_multiple_registers(modbus_rtu_t *mb, uint8_t unit_id,
     if (regs_len < qty) return ESP_ERR_INVALID_SIZE;
 
     size_t byte_count = qty * 2;
-    size_t req_len = 6 + byte_count;
-    uint8_t req[6 + 246];
-
+    modbus_rtu_frame_t f;
+    uint8_t *req = modbus_rtu_frame_pdu(&f);
     req[0] = MB_FC_WRITE_MULTIPLE_REGS;
     put_u16_be(&req[1], addr);
     put_u16_be(&req[3], qty);
     req[5] = (uint8_t)byte_count;
     for (uint16_t i = 0; i < qty; ++i) put_u16_be(&req[6 + i * 2], regs[i]);
 
-    uint8_t rsp[16];
+    const uint8_t *rsp = NULL;
     size_t rsp_len = 0;
-    esp_err_t err = modbus_rtu_master_transaction(mb, unit_id, req, req_len, rsp, sizeof(rsp), &rsp_len, ex);
-    if (err != ESP_OK) return err;
-
-    if (rsp_len != 5 || rsp[0] != MB_FC_WRITE_MULTIPLE_REGS) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
-    if (get_u16_be(&rsp[1]) != addr || get_u16_be(&rsp[3]) != qty) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
-    return ESP_OK;
+    esp_err_t err = modbus_rtu_master_transaction_frame(mb, unit_id, &f, 6 + byte_count, &rsp, &rsp_len, ex);
+    if (err != ESP_OK || unit_id == 0) return err;
+    return mb_check_echo(rsp, rsp_len, MB_FC_WRITE_MULTIPLE_REGS, addr, qty);
 }
 
 esp_err_t modbus_rtu_mask_write_register(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr,
                                         uint16_t and_mask, uint16_t or_mask,
                                         modbus_rtu_exception_t *ex)
 {
-    uint8_t req[7];
+    modbus_rtu_frame_t f;
+    uint8_t *req = modbus_rtu_frame_pdu(&f);
     req[0] = MB_FC_MASK_WRITE_REG;
     put_u16_be(&req[1], addr);
     put_u16_be(&req[3], and_mask);
     put_u16_be(&req[5], or_mask);
 
-    uint8_t rsp[16];
+    const uint8_t *rsp = NULL;
     size_t rsp_len = 0;
-    esp_err_t err = modbus_rtu_master_transaction(mb, unit_id, req, sizeof(req), rsp, sizeof(rsp), &rsp_len, ex);
-    if (err != ESP_OK) return err;
+    esp_err_t err = modbus_rtu_master_transaction_frame(mb, unit_id, &f, 7, &rsp, &rsp_len, ex);
+    if (err != ESP_OK || unit_id == 0) return err;
 
-    if (rsp_len != sizeof(req) || memcmp(rsp, req, sizeof(req)) != 0) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    if (!rsp || rsp_len != 7 || rsp[0] != MB_FC_MASK_WRITE_REG) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    if (get_u16_be(&rsp[1]) != addr || get_u16_be(&rsp[3]) != and_mask || get_u16_be(&rsp[5]) != or_mask) {
+        return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    }
     return ESP_OK;
 }
 
@@ -384,14 +774,14 @@ esp_err_t modbus_rtu_readwrite_multiple_registers(modbus_rtu_t *mb, uint8_t unit
                                                  modbus_rtu_exception_t *ex)
 {
     if (!write_regs || !out_read_regs) return ESP_ERR_INVALID_ARG;
+    if (unit_id == 0) return ESP_ERR_INVALID_ARG;    // reads cannot be broadcast
     if (read_qty < 1 || read_qty > 125) return ESP_ERR_INVALID_ARG;
     if (write_qty < 1 || write_qty > 121) return ESP_ERR_INVALID_ARG;
     if (write_regs_len < write_qty || out_read_regs_len < read_qty) return ESP_ERR_INVALID_SIZE;
 
     size_t write_byte_count = write_qty * 2;
-    size_t req_len = 10 + write_byte_count;
-    uint8_t req[10 + 242];
-
+    modbus_rtu_frame_t f;
+    uint8_t *req = modbus_rtu_frame_pdu(&f);
     req[0] = MB_FC_READWRITE_MULTIPLE_REGS;
     put_u16_be(&req[1], read_addr);
     put_u16_be(&req[3], read_qty);
@@ -400,12 +790,12 @@ esp_err_t modbus_rtu_readwrite_multiple_registers(modbus_rtu_t *mb, uint8_t unit
     req[9] = (uint8_t)write_byte_count;
     for (uint16_t i = 0; i < write_qty; ++i) put_u16_be(&req[10 + i * 2], write_regs[i]);
 
-    uint8_t rsp[MB_ADU_MAX_DEFAULT];
+    const uint8_t *rsp = NULL;
     size_t rsp_len = 0;
-    esp_err_t err = modbus_rtu_master_transaction(mb, unit_id, req, req_len, rsp, sizeof(rsp), &rsp_len, ex);
+    esp_err_t err = modbus_rtu_master_transaction_frame(mb, unit_id, &f, 10 + write_byte_count, &rsp, &rsp_len, ex);
     if (err != ESP_OK) return err;
 
-    if (rsp_len < 2 || rsp[0] != MB_FC_READWRITE_MULTIPLE_REGS) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    if (!rsp || rsp_len < 2 || rsp[0] != MB_FC_READWRITE_MULTIPLE_REGS) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
     uint8_t byte_count = rsp[1];
     if (byte_count != (uint8_t)(read_qty * 2) || rsp_len != (size_t)(2 + byte_count)) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
 
@@ -421,78 +811,311 @@ static void mb_build_exception_pdu(uint8_t function, uint8_t ex_code, uint8_t *o
     *out_len = 2;
 }
 
-static esp_err_t mb_slave_reply(modbus_rtu_t *mb, uint8_t unit_id, const uint8_t *pdu, size_t pdu_len)
+static esp_err_t mb_slave_reply(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_frame_t *f, size_t pdu_len)
 {
-    uint8_t adu[MB_ADU_MAX_DEFAULT];
-    size_t adu_len = 0;
-    esp_err_t err = mb_build_adu(unit_id, pdu, pdu_len, adu, sizeof(adu), &adu_len);
-    if (err != ESP_OK) return err;
-    return mb_port_write_adu(&mb->port, adu, adu_len);
+    mb_frame_seal(f, unit_id, pdu_len);
+    return mb_port_write_adu(&mb->port, f->adu, f->adu_len);
 }
 
-static esp_err_t mb_slave_handle_request(modbus_rtu_t *mb, const uint8_t *adu, size_t adu_len)
+// ---- Slave data access: mapped storage first, callbacks otherwise ----
+// Each returns 0 or a Modbus exception code. Register payloads are wire order
+// (big-endian), bit payloads packed LSB first, both in place in the PDU.
+
+static uint8_t mb_cb_ex(esp_err_t err)
 {
-    if (adu_len < 5) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    if (err == ESP_OK) return 0;
+    return err == ESP_ERR_NOT_SUPPORTED ? MB_EX_ILLEGAL_FUNCTION : MB_EX_ILLEGAL_DATA_ADDR;
+}
 
-    uint16_t got = (uint16_t)(adu[adu_len - 2] | (adu[adu_len - 1] << 8));
-    uint16_t calc = modbus_rtu_crc16(adu, adu_len - 2);
-    if (got != calc) return ESP_ERR_MODBUS_RTU_CRC;
+static uint8_t mb_no_handler_ex(const mb_unit_t *u)
+{
+    return u->model ? MB_EX_ILLEGAL_DATA_ADDR : MB_EX_ILLEGAL_FUNCTION;
+}
 
-    uint8_t unit_id = adu[0];
-    if (unit_id == 0) return ESP_OK; // broadcast ignored
-    if (unit_id != mb->slave_cfg.unit_id) return ESP_OK;
+// out must be zeroed for (qty + 7) / 8 bytes
+static uint8_t mb_slave_get_bits(const mb_unit_t *u, uint8_t table, uint16_t addr, uint16_t qty, uint8_t *out)
+{
+    const modbus_rtu_region_t *rg = mb_model_find(u->model, table, addr, qty);
+    if (rg && rg->storage) {
+        mb_bits_copy(out, 0, (const uint8_t*)rg->storage, addr - rg->start, qty);
+        return 0;
+    }
+    modbus_rtu_read_bits_cb_t rd = (table == MODBUS_RTU_TABLE_COILS) ? u->cb.read_coils : u->cb.read_discrete_inputs;
+    if (!rd) return mb_no_handler_ex(u);
+    return mb_cb_ex(rd(addr, qty, out, u->user_ctx));
+}
 
-    const uint8_t *pdu = &adu[1];
-    size_t pdu_len = adu_len - 1 - 2;
-    if (pdu_len < 1) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+static uint8_t mb_slave_set_bits(const mb_unit_t *u, uint16_t addr, uint16_t qty, const uint8_t *src)
+{
+    const modbus_rtu_region_t *rg = mb_model_find(u->model, MODBUS_RTU_TABLE_COILS, addr, qty);
+    if (rg && rg->storage) {
+        mb_bits_copy((uint8_t*)rg->storage, addr - rg->start, src, 0, qty);
+        return 0;
+    }
+    if (!u->cb.write_coils) return mb_no_handler_ex(u);
+    return mb_cb_ex(u->cb.write_coils(addr, qty, src, u->user_ctx));
+}
+
+// out must be 2-byte aligned: callbacks fill host-order words there, which
+// are then swapped to wire order in place.
+static uint8_t mb_slave_get_regs(const mb_unit_t *u, uint8_t table, uint16_t addr, uint16_t qty, uint8_t *out)
+{
+    const modbus_rtu_region_t *rg = mb_model_find(u->model, table, addr, qty);
+    if (rg && rg->storage) {
+        const uint16_t *src = (const uint16_t*)rg->storage + (addr - rg->start);
+        for (uint16_t i = 0; i < qty; ++i) put_u16_be(&out[i * 2], src[i]);
+        return 0;
+    }
+
+    uint16_t *w = (uint16_t*)(void*)out;
+    if (rg && rg->bank) {
+        modbus_rtu_reg_bank_read(rg->bank, addr - rg->start, w, qty);     // consistent snapshot
+    } else {
+        modbus_rtu_read_regs_cb_t rd = (table == MODBUS_RTU_TABLE_HOLDING) ? u->cb.read_holding : u->cb.read_input;
+        if (!rd) return mb_no_handler_ex(u);
+        uint8_t ex = mb_cb_ex(rd(addr, qty, w, u->user_ctx));
+        if (ex) return ex;
+    }
+    for (uint16_t i = 0; i < qty; ++i) put_u16_be(&out[i * 2], w[i]);
+    return 0;
+}
 
+// scratch: 2-byte aligned, qty words, only used for the callback path
+static uint8_t mb_slave_set_regs(const mb_unit_t *u, uint16_t addr, uint16_t qty, const uint8_t *src, uint16_t *scratch)
+{
+    const modbus_rtu_region_t *rg = mb_model_find(u->model, MODBUS_RTU_TABLE_HOLDING, addr, qty);
+    if (rg && rg->storage) {
+        uint16_t *dst = (uint16_t*)rg->storage + (addr - rg->start);
+        for (uint16_t i = 0; i < qty; ++i) dst[i] = get_u16_be(&src[i * 2]);
+        return 0;
+    }
+    if (rg && rg->bank) {
+        uint16_t *dst = rg->bank->regs + (addr - rg->start);
+        mb_bank_write_begin(rg->bank);
+        for (uint16_t i = 0; i < qty; ++i) dst[i] = get_u16_be(&src[i * 2]);
+        mb_bank_write_end(rg->bank);
+        return 0;
+    }
+    if (!u->cb.write_holding) return mb_no_handler_ex(u);
+    for (uint16_t i = 0; i < qty; ++i) scratch[i] = get_u16_be(&src[i * 2]);
+    return mb_cb_ex(u->cb.write_holding(addr, qty, scratch, u->user_ctx));
+}
+
+// Executes one request PDU against unit u and sends the reply, if any
+static esp_err_t mb_slave_serve(modbus_rtu_t *mb, const mb_unit_t *u, uint8_t unit_id,
+                                const uint8_t *pdu, size_t pdu_len, bool reply, int64_t rx_at_us)
+{
     uint8_t fc = pdu[0];
-    uint8_t rsp_pdu[MB_ADU_MAX_DEFAULT];
+    modbus_rtu_frame_t rf;                          // response built in place, payload word aligned
+    uint8_t *rsp_pdu = modbus_rtu_frame_pdu(&rf);
+    uint16_t *scratch = (uint16_t*)(void*)&rsp_pdu[2];
     size_t rsp_len = 0;
+    uint8_t ex = 0;
 
     switch (fc) {
+        case MB_FC_READ_COILS:
+        case MB_FC_READ_DISCRETE_INPUTS: {
+            if (pdu_len != 5) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+            uint16_t addr = get_u16_be(&pdu[1]);
+            uint16_t qty  = get_u16_be(&pdu[3]);
+            if (qty < 1 || qty > 2000) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+
+            uint8_t nbytes = (uint8_t)((qty + 7) / 8);
+            memset(&rsp_pdu[2], 0, nbytes);
+            ex = mb_slave_get_bits(u, fc, addr, qty, &rsp_pdu[2]);
+            if (ex) break;
+            rsp_pdu[0] = fc;
+            rsp_pdu[1] = nbytes;
+            rsp_len = 2 + nbytes;
+            break;
+        }
+
         case MB_FC_READ_HOLDING_REGS:
         case MB_FC_READ_INPUT_REGS: {
-            if (pdu_len != 5) { mb_build_exception_pdu(fc, MB_EX_ILLEGAL_DATA_VALUE, rsp_pdu, &rsp_len); break; }
+            if (pdu_len != 5) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+            uint16_t addr = get_u16_be(&pdu[1]);
+            uint16_t qty  = get_u16_be(&pdu[3]);
+            if (qty < 1 || qty > 125) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+
+            ex = mb_slave_get_regs(u, fc, addr, qty, &rsp_pdu[2]);
+            if (ex) break;
+            rsp_pdu[0] = fc;
+            rsp_pdu[1] = (uint8_t)(qty * 2);
+            rsp_len = 2 + qty * 2;
+            break;
+        }
+
+        case MB_FC_WRITE_SINGLE_COIL: {
+            if (pdu_len != 5) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+            uint16_t value = get_u16_be(&pdu[3]);
+            if (value != 0xFF00 && value != 0x0000) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+
+            uint8_t bit = value ? 1 : 0;
+            ex = mb_slave_set_bits(u, get_u16_be(&pdu[1]), 1, &bit);
+            if (ex) break;
+            memcpy(rsp_pdu, pdu, 5);     // echo
+            rsp_len = 5;
+            break;
+        }
+
+        case MB_FC_WRITE_SINGLE_REG: {
+            if (pdu_len != 5) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+            ex = mb_slave_set_regs(u, get_u16_be(&pdu[1]), 1, &pdu[3], scratch);
+            if (ex) break;
+            memcpy(rsp_pdu, pdu, 5);
+            rsp_len = 5;
+            break;
+        }
+
+        case MB_FC_WRITE_MULTIPLE_COILS: {
+            if (pdu_len < 6) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
             uint16_t addr = get_u16_be(&pdu[1]);
             uint16_t qty  = get_u16_be(&pdu[3]);
-            if (qty < 1 || qty > 125) { mb_build_exception_pdu(fc, MB_EX_ILLEGAL_DATA_VALUE, rsp_pdu, &rsp_len); break; }
-
-            uint16_t regs[125];
-            esp_err_t cb_err = ESP_ERR_NOT_SUPPORTED;
-            if (fc == MB_FC_READ_HOLDING_REGS && mb->cb.read_holding) cb_err = mb->cb.read_holding(addr, qty, regs, mb->user_ctx);
-            if (fc == MB_FC_READ_INPUT_REGS   && mb->cb.read_input)   cb_err = mb->cb.read_input(addr, qty, regs, mb->user_ctx);
-
-            if (cb_err == ESP_OK) {
-                rsp_pdu[0] = fc;
-                rsp_pdu[1] = (uint8_t)(qty * 2);
-                for (uint16_t i = 0; i < qty; ++i) put_u16_be(&rsp_pdu[2 + i * 2], regs[i]);
-                rsp_len = 2 + qty * 2;
-            } else if (cb_err == ESP_ERR_NOT_SUPPORTED) mb_build_exception_pdu(fc, MB_EX_ILLEGAL_FUNCTION, rsp_pdu, &rsp_len);
-            else mb_build_exception_pdu(fc, MB_EX_ILLEGAL_DATA_ADDR, rsp_pdu, &rsp_len);
+            uint8_t bc = pdu[5];
+            if (qty < 1 || qty > 1968 || bc != (qty + 7) / 8 || pdu_len != 6u + bc) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+
+            ex = mb_slave_set_bits(u, addr, qty, &pdu[6]);     // packed straight from the request
+            if (ex) break;
+            memcpy(rsp_pdu, pdu, 5);
+            rsp_len = 5;
+            break;
+        }
+
+        case MB_FC_WRITE_MULTIPLE_REGS: {
+            if (pdu_len < 6) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+            uint16_t addr = get_u16_be(&pdu[1]);
+            uint16_t qty  = get_u16_be(&pdu[3]);
+            uint8_t bc = pdu[5];
+            if (qty < 1 || qty > 123 || bc != qty * 2 || pdu_len != 6u + bc) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+
+            ex = mb_slave_set_regs(u, addr, qty, &pdu[6], scratch);
+            if (ex) break;
+            memcpy(rsp_pdu, pdu, 5);
+            rsp_len = 5;
+            break;
+        }
+
+        case MB_FC_MASK_WRITE_REG: {
+            if (pdu_len != 7) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+            uint16_t addr = get_u16_be(&pdu[1]);
+            uint16_t and_mask = get_u16_be(&pdu[3]);
+            uint16_t or_mask  = get_u16_be(&pdu[5]);
+
+            const modbus_rtu_region_t *rg = mb_model_find(u->model, MODBUS_RTU_TABLE_HOLDING, addr, 1);
+            if (rg && rg->bank) {
+                // atomic against application writers
+                uint16_t *r = &rg->bank->regs[addr - rg->start];
+                mb_bank_write_begin(rg->bank);
+                *r = (uint16_t)((*r & and_mask) | (or_mask & (uint16_t)~and_mask));
+                mb_bank_write_end(rg->bank);
+                memcpy(rsp_pdu, pdu, 7);
+                rsp_len = 7;
+                break;
+            }
+
+            uint8_t cur[2];
+            ex = mb_slave_get_regs(u, MODBUS_RTU_TABLE_HOLDING, addr, 1, &rsp_pdu[2]);
+            if (ex) break;
+            uint16_t v = get_u16_be(&rsp_pdu[2]);
+            v = (uint16_t)((v & and_mask) | (or_mask & (uint16_t)~and_mask));
+            put_u16_be(cur, v);
+            ex = mb_slave_set_regs(u, addr, 1, cur, scratch);
+            if (ex) break;
+            memcpy(rsp_pdu, pdu, 7);
+            rsp_len = 7;
+            break;
+        }
+
+        case MB_FC_READWRITE_MULTIPLE_REGS: {
+            if (pdu_len < 10) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+            uint16_t raddr = get_u16_be(&pdu[1]);
+            uint16_t rqty  = get_u16_be(&pdu[3]);
+            uint16_t waddr = get_u16_be(&pdu[5]);
+            uint16_t wqty  = get_u16_be(&pdu[7]);
+            uint8_t bc = pdu[9];
+            if (rqty < 1 || rqty > 125 || wqty < 1 || wqty > 121 ||
+                bc != wqty * 2 || pdu_len != 10u + bc) { ex = MB_EX_ILLEGAL_DATA_VALUE; break; }
+
+            // write happens before the read (spec)
+            ex = mb_slave_set_regs(u, waddr, wqty, &pdu[10], scratch);
+            if (ex) break;
+            ex = mb_slave_get_regs(u, MODBUS_RTU_TABLE_HOLDING, raddr, rqty, &rsp_pdu[2]);
+            if (ex) break;
+            rsp_pdu[0] = fc;
+            rsp_pdu[1] = (uint8_t)(rqty * 2);
+            rsp_len = 2 + rqty * 2;
             break;
         }
 
         default: {
-            if (mb->cb.custom_function) {
+            if (u->cb.custom_function) {
                 size_t out_len = 0;
-                esp_err_t cerr = mb->cb.custom_function(unit_id, fc, pdu, pdu_len, rsp_pdu, sizeof(rsp_pdu), &out_len, mb->user_ctx);
+                esp_err_t cerr = u->cb.custom_function(unit_id, fc, pdu, pdu_len, rsp_pdu, MODBUS_RTU_PDU_MAX, &out_len, u->user_ctx);
                 if (cerr == ESP_OK && out_len >= 1) { rsp_len = out_len; break; }
             }
-            mb_build_exception_pdu(fc, MB_EX_ILLEGAL_FUNCTION, rsp_pdu, &rsp_len);
+            ex = MB_EX_ILLEGAL_FUNCTION;
             break;
         }
     }
 
-    if (rsp_len) return mb_slave_reply(mb, unit_id, rsp_pdu, rsp_len);
-    return ESP_OK;
+    if (ex) mb_build_exception_pdu(fc, ex, rsp_pdu, &rsp_len);
+    if (!rsp_len || !reply) return ESP_OK;
+
+    esp_err_t err = mb_slave_reply(mb, unit_id, &rf, rsp_len);
+    if (err == ESP_OK) {
+        mb_stats_frame(mb, rf.adu_len, 0);
+        mb_stats_result(mb, unit_id, ex ? ESP_ERR_MODBUS_RTU_EXCEPTION : ESP_OK, ex, mb_time_us() - rx_at_us);
+    }
+    return err;
+}
+
+static esp_err_t mb_slave_handle_request(modbus_rtu_t *mb, const uint8_t *adu, size_t adu_len)
+{
+    int64_t rx_at_us = mb_time_us();
+    mb_stats_frame(mb, 0, adu_len);
+    if (adu_len < 5) { mb_stats_result(mb, 0, ESP_ERR_MODBUS_RTU_FRAME, 0, -1); return ESP_ERR_MODBUS_RTU_BAD_RESPONSE; }
+
+    uint16_t got = (uint16_t)(adu[adu_len - 2] | (adu[adu_len - 1] << 8));
+    uint16_t calc = modbus_rtu_crc16(adu, adu_len - 2);
+    if (got != calc) { mb_stats_result(mb, 0, ESP_ERR_MODBUS_RTU_CRC, 0, -1); return ESP_ERR_MODBUS_RTU_CRC; }
+
+    uint8_t unit_id = adu[0];
+    const uint8_t *pdu = &adu[1];
+    size_t pdu_len = adu_len - 1 - 2;
+    esp_err_t err = ESP_OK;
+
+    if (unit_id == 0) {
+        // Broadcast: writes only, applied to every unit, never answered
+        uint8_t fc = pdu[0];
+        if (fc != MB_FC_WRITE_SINGLE_COIL && fc != MB_FC_WRITE_SINGLE_REG &&
+            fc != MB_FC_WRITE_MULTIPLE_COILS && fc != MB_FC_WRITE_MULTIPLE_REGS) return ESP_OK;
+
+        mb_stats_request(mb, 0);
+        xSemaphoreTake(mb->units_lock, portMAX_DELAY);
+        for (int i = 1; i <= 247; ++i) {
+            if (mb->units[i]) (void)mb_slave_serve(mb, mb->units[i], 0, pdu, pdu_len, false, rx_at_us);
+        }
+        xSemaphoreGive(mb->units_lock);
+        return ESP_OK;
+    }
+
+    // Direct index by unit id, independent of how many units are served
+    xSemaphoreTake(mb->units_lock, portMAX_DELAY);
+    const mb_unit_t *u = mb->units[unit_id];
+    if (u) {
+        mb_stats_request(mb, unit_id);
+        err = mb_slave_serve(mb, u, unit_id, pdu, pdu_len, true, rx_at_us);
+    }
+    xSemaphoreGive(mb->units_lock);
+    return err;
 }
 
 static void mb_slave_task(void *arg)
 {
     modbus_rtu_t *mb = (modbus_rtu_t*)arg;
-    uint8_t *rx = (uint8_t*)malloc(mb->slave_cfg.max_adu_size);
-    if (!rx) { mb->slave_running = false; vTaskDelete(NULL); return; }
+    modbus_rtu_slave_static_t *st = mb->slave_static;
+    uint8_t *rx = st ? st->rx : (uint8_t*)malloc(mb->slave_cfg.max_adu_size);
+    if (!rx) { mb->slave_running = false; mb->slave_task = NULL; vTaskDelete(NULL); return; }
 
     mb->slave_running = true;
     MB_LOGI(TAG, "Slave started (unit_id=%u)", mb->slave_cfg.unit_id);
@@ -501,11 +1124,17 @@ static void mb_slave_task(void *arg)
         size_t rx_len = 0;
         esp_err_t err = mb_port_read_frame(&mb->port, rx, mb->slave_cfg.max_adu_size, &rx_len, 1000);
         if (err == ESP_OK && rx_len > 0) (void)mb_slave_handle_request(mb, rx, rx_len);
-        vTaskDelay(pdMS_TO_TICKS(mb->slave_cfg.rx_poll_delay_ms));
+        // In event mode read_frame already blocks on the UART queue.
+        if (mb->port.rx_mode != MODBUS_RTU_RX_EVENT) vTaskDelay(pdMS_TO_TICKS(mb->slave_cfg.rx_poll_delay_ms));
     }
 
+    if (st) {
+        // The TCB and stack belong to the caller: park here and let stop()
+        // delete the task, so the storage is free once stop() returns.
+        for (;;) vTaskSuspend(NULL);
+    }
     free(rx);
-    mb->slave_task = NULL;
+    mb->slave_task = NULL;      // last touch of mb, stop() waits for this
     vTaskDelete(NULL);
 }
 
@@ -515,7 +1144,13 @@ esp_err_t modbus_rtu_slave_start(modbus_rtu_t *mb)
     if (mb->slave_task) return ESP_ERR_INVALID_STATE;
 
     mb->slave_running = true;
-    BaseType_t ok = xTaskCreate(mb_slave_task, "mb_slave", 4096, mb, 10, &mb->slave_task);
+    modbus_rtu_slave_static_t *st = mb->slave_static;
+    if (st) {
+        mb->slave_task = xTaskCreateStatic(mb_slave_task, "mb_slave", sizeof(st->stack) / sizeof(st->stack[0]),
+                                           mb, 10, st->stack, &st->task);
+        return mb->slave_task ? ESP_OK : ESP_ERR_INVALID_STATE;
+    }
+    BaseType_t ok = xTaskCreate(mb_slave_task, "mb_slave", CONFIG_MODBUS_RTU_SLAVE_TASK_STACK, mb, 10, &mb->slave_task);
     return (ok == pdPASS) ? ESP_OK : ESP_ERR_NO_MEM;
 }
 
@@ -524,6 +1159,14 @@ esp_err_t modbus_rtu_slave_stop(modbus_rtu_t *mb)
     if (!mb || mb->role != MB_ROLE_SLAVE) return ESP_ERR_INVALID_STATE;
     if (!mb->slave_task) return ESP_OK;
     mb->slave_running = false;
-    vTaskDelay(pdMS_TO_TICKS(20));
+    // Up to one RX timeout until the task sees the flag
+    if (mb->slave_static) {
+        TaskHandle_t t = mb->slave_task;
+        while (eTaskGetState(t) != eSuspended) vTaskDelay(pdMS_TO_TICKS(10));
+        vTaskDelete(t);
+        mb->slave_task = NULL;
+        return ESP_OK;
+    }
+    while (*(volatile TaskHandle_t*)&mb->slave_task) vTaskDelay(pdMS_TO_TICKS(10));
     return ESP_OK;
 }
@@ -0,0 +1,211 @@
+#include "modbus_rtu_internal.h"
+
+static const char *TAG = "modbus_rtu_adapt";
+
+typedef struct {
+    bool measured;
+    bool quarantined;
+    uint32_t srtt_us;
+    uint32_t rttvar_us;
+    uint32_t backoff;               // timeout multiplier after unanswered requests
+    uint32_t consecutive_timeouts;
+    uint32_t probe_ms;              // current back-off period
+    int64_t next_probe_us;
+} mb_adapt_unit_t;
+
+struct mb_adapt_s {
+    modbus_rtu_adaptive_config_t cfg;
+    mb_adapt_unit_t *units[256];    // allocated on first request to the unit
+};
+
+static uint32_t mb_adapt_timeout_ms(const modbus_rtu_t *mb, const mb_adapt_unit_t *u, size_t rsp_len)
+{
+    const modbus_rtu_adaptive_config_t *c = &mb->adapt->cfg;
+    if (!u || !u->measured) return c->max_timeout_ms;
+
+    // RFC 6298 RTO, with the timer granularity as floor for the variance term
+    uint32_t var = 4u * u->rttvar_us;
+    if (var < 1000u) var = 1000u;
+    uint64_t us = (uint64_t)u->srtt_us + var;
+    if (rsp_len == 0) rsp_len = MODBUS_RTU_ADU_MAX;
+    us += (uint64_t)rsp_len * mb->port.char_time_us + (uint64_t)mb->port.inter_frame_timeout_us;
+    us *= u->backoff;
+
+    uint64_t ms = (us + 999u) / 1000u;
+    if (ms < c->min_timeout_ms) ms = c->min_timeout_ms;
+    if (ms > c->max_timeout_ms) ms = c->max_timeout_ms;
+    return (uint32_t)ms;
+}
+
+static void mb_adapt_sample(mb_adapt_unit_t *u, uint32_t r)
+{
+    if (!u->measured) {
+        u->srtt_us = r;
+        u->rttvar_us = r / 2;
+        u->measured = true;
+        return;
+    }
+    uint32_t d = (u->srtt_us > r) ? u->srtt_us - r : r - u->srtt_us;
+    u->rttvar_us = u->rttvar_us - u->rttvar_us / 4 + d / 4;
+    u->srtt_us = u->srtt_us - u->srtt_us / 8 + r / 8;
+}
+
+esp_err_t mb_adapt_begin(modbus_rtu_t *mb, uint8_t unit_id, size_t rsp_len, int *timeout_ms)
+{
+    struct mb_adapt_s *a = mb->adapt;
+    mb_adapt_unit_t *u = a->units[unit_id];
+    if (!u) {
+        u = (mb_adapt_unit_t*)calloc(1, sizeof(mb_adapt_unit_t));
+        if (!u) return ESP_OK;      // run with the static timeout
+        u->backoff = 1;
+        a->units[unit_id] = u;
+    }
+
+    if (u->quarantined) {
+        if (mb_time_us() < u->next_probe_us) return ESP_ERR_MODBUS_RTU_OFFLINE;
+        *timeout_ms = (int)a->cfg.max_timeout_ms;   // probe
+        return ESP_OK;
+    }
+    *timeout_ms = (int)mb_adapt_timeout_ms(mb, u, rsp_len);
+    return ESP_OK;
+}
+
+int mb_adapt_end(modbus_rtu_t *mb, uint8_t unit_id, esp_err_t err, size_t rx_len, int64_t elapsed_us)
+{
+    struct mb_adapt_s *a = mb->adapt;
+    mb_adapt_unit_t *u = a->units[unit_id];
+    if (!u) return -1;
+
+    if (err == ESP_ERR_MODBUS_RTU_TIMEOUT) {
+        u->consecutive_timeouts++;
+        if (u->quarantined) {
+            // Failed probe
+            u->probe_ms = (u->probe_ms >= a->cfg.probe_max_ms / 2) ? a->cfg.probe_max_ms : u->probe_ms * 2;
+            u->next_probe_us = mb_time_us() + (int64_t)u->probe_ms * 1000;
+            return -1;
+        }
+        if (u->backoff < 64) u->backoff *= 2;
+        if (u->consecutive_timeouts < a->cfg.quarantine_after) return -1;
+        u->quarantined = true;
+        u->probe_ms = a->cfg.probe_initial_ms;
+        u->next_probe_us = mb_time_us() + (int64_t)u->probe_ms * 1000;
+        return MODBUS_RTU_UNIT_QUARANTINED;
+    }
+
+    // Something answered. Only clean responses are timed: a CRC or framing
+    // error says the unit is alive but not when its reply really ended.
+    if (err != ESP_OK && err != ESP_ERR_MODBUS_RTU_EXCEPTION && err != ESP_ERR_MODBUS_RTU_CRC &&
+        err != ESP_ERR_MODBUS_RTU_BAD_RESPONSE && err != ESP_ERR_MODBUS_RTU_FRAME) {
+        return -1;  // port trouble says nothing about the unit
+    }
+    if (err == ESP_OK || err == ESP_ERR_MODBUS_RTU_EXCEPTION) {
+        int64_t r = elapsed_us - (int64_t)rx_len * mb->port.char_time_us - mb->port.inter_frame_timeout_us;
+        mb_adapt_sample(u, r > 0 ? (uint32_t)r : 0);
+    }
+    u->backoff = 1;
+    u->consecutive_timeouts = 0;
+    if (!u->quarantined) return -1;
+    u->quarantined = false;
+    return MODBUS_RTU_UNIT_ONLINE;
+}
+
+void mb_adapt_notify(modbus_rtu_t *mb, uint8_t unit_id, int state)
+{
+    struct mb_adapt_s *a = mb->adapt;
+    if (state < 0 || !a) return;
+    MB_LOGW(TAG, "Unit %u %s", unit_id, state == MODBUS_RTU_UNIT_QUARANTINED ? "quarantined" : "back online");
+    if (a->cfg.on_state_change) a->cfg.on_state_change(mb, unit_id, (modbus_rtu_unit_state_t)state, a->cfg.user);
+}
+
+void mb_adapt_defer(mb_adapt_pending_t *pd, uint8_t unit_id, int state)
+{
+    if (state < 0) return;
+    uint32_t bit = 1u << (unit_id % 32);
+    pd->changed[unit_id / 32] ^= bit;
+    if (state == MODBUS_RTU_UNIT_QUARANTINED) pd->quarantined[unit_id / 32] |= bit;
+    else pd->quarantined[unit_id / 32] &= ~bit;
+}
+
+void mb_adapt_flush(modbus_rtu_t *mb, const mb_adapt_pending_t *pd)
+{
+    for (int u = 1; u < 256; ++u) {
+        uint32_t bit = 1u << (u % 32);
+        if (!(pd->changed[u / 32] & bit)) continue;
+        mb_adapt_notify(mb, (uint8_t)u, (pd->quarantined[u / 32] & bit) ? MODBUS_RTU_UNIT_QUARANTINED : MODBUS_RTU_UNIT_ONLINE);
+    }
+}
+
+esp_err_t modbus_rtu_master_adaptive_enable(modbus_rtu_t *mb, const modbus_rtu_adaptive_config_t *cfg)
+{
+    if (!mb || mb->role != MB_ROLE_MASTER) return ESP_ERR_INVALID_STATE;
+    if (mb->adapt) return ESP_ERR_INVALID_STATE;
+
+    struct mb_adapt_s *a = (struct mb_adapt_s*)calloc(1, sizeof(struct mb_adapt_s));
+    if (!a) return ESP_ERR_NO_MEM;
+
+    if (cfg) a->cfg = *cfg;
+    if (a->cfg.max_timeout_ms == 0) a->cfg.max_timeout_ms = (uint32_t)mb->master_cfg.response_timeout_ms;
+    if (a->cfg.min_timeout_ms == 0) a->cfg.min_timeout_ms = 20;
+    if (a->cfg.min_timeout_ms > a->cfg.max_timeout_ms) a->cfg.min_timeout_ms = a->cfg.max_timeout_ms;
+    if (a->cfg.quarantine_after == 0) a->cfg.quarantine_after = 3;
+    if (a->cfg.probe_initial_ms == 0) a->cfg.probe_initial_ms = 1000;
+    if (a->cfg.probe_max_ms == 0) a->cfg.probe_max_ms = 60000;
+    if (a->cfg.probe_max_ms < a->cfg.probe_initial_ms) a->cfg.probe_max_ms = a->cfg.probe_initial_ms;
+
+    xSemaphoreTake(mb->master_mutex, portMAX_DELAY);
+    mb->adapt = a;
+    xSemaphoreGive(mb->master_mutex);
+    return ESP_OK;
+}
+
+void modbus_rtu_master_adaptive_disable(modbus_rtu_t *mb)
+{
+    if (!mb || !mb->adapt) return;
+    xSemaphoreTake(mb->master_mutex, portMAX_DELAY);
+    struct mb_adapt_s *a = mb->adapt;
+    mb->adapt = NULL;
+    xSemaphoreGive(mb->master_mutex);
+
+    for (int i = 0; i < 256; ++i) free(a->units[i]);
+    free(a);
+}
+
+esp_err_t modbus_rtu_master_unit_health(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_unit_health_t *out)
+{
+    if (!mb || !out || unit_id == 0) return ESP_ERR_INVALID_ARG;
+    if (!mb->adapt) return ESP_ERR_INVALID_STATE;
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(mb->master_mutex, portMAX_DELAY);
+    const mb_adapt_unit_t *u = mb->adapt->units[unit_id];
+    if (!u) {
+        err = ESP_ERR_NOT_FOUND;
+    } else {
+        int64_t left_us = u->quarantined ? u->next_probe_us - mb_time_us() : 0;
+        out->state = u->quarantined ? MODBUS_RTU_UNIT_QUARANTINED : MODBUS_RTU_UNIT_ONLINE;
+        out->srtt_us = u->srtt_us;
+        out->rttvar_us = u->rttvar_us;
+        out->timeout_ms = mb_adapt_timeout_ms(mb, u, 0);
+        out->consecutive_timeouts = u->consecutive_timeouts;
+        out->next_probe_ms = left_us > 0 ? (uint32_t)((left_us + 999) / 1000) : 0;
+    }
+    xSemaphoreGive(mb->master_mutex);
+    return err;
+}
+
+esp_err_t modbus_rtu_master_unit_reset(modbus_rtu_t *mb, uint8_t unit_id)
+{
+    if (!mb || unit_id == 0) return ESP_ERR_INVALID_ARG;
+    if (!mb->adapt) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(mb->master_mutex, portMAX_DELAY);
+    mb_adapt_unit_t *u = mb->adapt->units[unit_id];
+    mb->adapt->units[unit_id] = NULL;
+    xSemaphoreGive(mb->master_mutex);
+
+    if (!u) return ESP_ERR_NOT_FOUND;
+    bool was_quarantined = u->quarantined;
+    free(u);
+    if (was_quarantined) mb_adapt_notify(mb, unit_id, MODBUS_RTU_UNIT_ONLINE);
+    return ESP_OK;
+}
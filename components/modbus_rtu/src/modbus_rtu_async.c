@@ -0,0 +1,166 @@
+#include "modbus_rtu_internal.h"
+
+static const char *TAG = "modbus_rtu_async";
+
+typedef struct {
+    modbus_rtu_async_req_t req;     // request_pdu points nowhere after submit
+    size_t pdu_len;
+    uint8_t pdu[MODBUS_RTU_PDU_MAX];
+    bool stop;
+} mb_async_item_t;
+
+typedef struct mb_async_s {
+    modbus_rtu_t *mb;
+    QueueHandle_t queue;
+    TaskHandle_t task;
+    SemaphoreHandle_t done;
+} mb_async_t;
+
+static void mb_async_complete(modbus_rtu_t *mb, const mb_async_item_t *it, esp_err_t err,
+                              const modbus_rtu_exception_t *ex, const uint8_t *rsp, size_t rsp_len)
+{
+    const modbus_rtu_async_req_t *r = &it->req;
+
+    // One outcome for out_err and the callback alike
+    bool want_pdu = r->out_pdu && r->out_pdu_len && rsp;
+    if (err == ESP_OK && want_pdu && rsp_len > r->out_pdu_max) err = ESP_ERR_NO_MEM;
+
+    if (r->out_err) *r->out_err = err;
+    if (r->out_ex) *r->out_ex = *ex;
+    if (r->out_pdu_len) *r->out_pdu_len = 0;
+    if (want_pdu && err == ESP_OK) {
+        memcpy(r->out_pdu, rsp, rsp_len);
+        *r->out_pdu_len = rsp_len;
+    }
+
+    if (r->callback) {
+        modbus_rtu_async_result_t res = {
+            .err = err,
+            .unit_id = r->unit_id,
+            .ex = *ex,
+            .response_pdu = rsp,
+            .response_pdu_len = rsp_len,
+            .user = r->user,
+            .mb = mb,
+        };
+        r->callback(&res);
+    }
+
+    if (r->notify_task) xTaskNotify(r->notify_task, r->notify_bits, eSetBits);
+}
+
+static void mb_async_task(void *arg)
+{
+    // Takes its own context, stop may clear mb->async before this runs
+    mb_async_t *a = (mb_async_t*)arg;
+    modbus_rtu_t *mb = a->mb;
+
+    mb_async_item_t it;
+    modbus_rtu_frame_t f;
+    const modbus_rtu_exception_t no_ex = {0};
+
+    while (xQueueReceive(a->queue, &it, portMAX_DELAY) == pdTRUE) {
+        if (it.stop) break;
+
+        modbus_rtu_exception_t ex = {0};
+        const uint8_t *rsp = NULL;
+        size_t rsp_len = 0;
+        memcpy(modbus_rtu_frame_pdu(&f), it.pdu, it.pdu_len);
+        esp_err_t err = modbus_rtu_master_transaction_frame(mb, it.req.unit_id, &f, it.pdu_len, &rsp, &rsp_len, &ex);
+        mb_async_complete(mb, &it, err, &ex, rsp, rsp_len);
+    }
+
+    // Fail whatever was still queued
+    while (xQueueReceive(a->queue, &it, 0) == pdTRUE) {
+        if (!it.stop) mb_async_complete(mb, &it, ESP_ERR_INVALID_STATE, &no_ex, NULL, 0);
+    }
+
+    xSemaphoreGive(a->done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t modbus_rtu_master_async_start(modbus_rtu_t *mb, const modbus_rtu_async_config_t *cfg)
+{
+    if (!mb || mb->role != MB_ROLE_MASTER) return ESP_ERR_INVALID_STATE;
+    if (mb->async) return ESP_ERR_INVALID_STATE;
+
+    modbus_rtu_async_config_t c = {0};
+    if (cfg) c = *cfg;
+    if (c.queue_len <= 0) c.queue_len = 16;
+    if (c.task_stack <= 0) c.task_stack = 4096;
+    if (c.task_priority <= 0) c.task_priority = 10;
+
+    mb_async_t *a = (mb_async_t*)calloc(1, sizeof(mb_async_t));
+    if (!a) return ESP_ERR_NO_MEM;
+
+    a->queue = xQueueCreate((UBaseType_t)c.queue_len, sizeof(mb_async_item_t));
+    a->done = xSemaphoreCreateBinary();
+    if (!a->queue || !a->done) goto fail;
+
+    a->mb = mb;
+    xSemaphoreTake(mb->async_lock, portMAX_DELAY);
+    mb->async = a;
+    xSemaphoreGive(mb->async_lock);
+    BaseType_t ok = xTaskCreatePinnedToCore(mb_async_task, "mb_async", (uint32_t)c.task_stack, a,
+                                            (UBaseType_t)c.task_priority, &a->task,
+                                            c.pin_to_core ? c.task_core : tskNO_AFFINITY);
+    if (ok != pdPASS) {
+        xSemaphoreTake(mb->async_lock, portMAX_DELAY);
+        mb->async = NULL;
+        xSemaphoreGive(mb->async_lock);
+        goto fail;
+    }
+
+    MB_LOGI(TAG, "Async bus task started (queue=%d)", c.queue_len);
+    return ESP_OK;
+
+fail:
+    if (a->queue) vQueueDelete(a->queue);
+    if (a->done) vSemaphoreDelete(a->done);
+    free(a);
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t modbus_rtu_master_async_stop(modbus_rtu_t *mb)
+{
+    if (!mb || mb->role != MB_ROLE_MASTER) return ESP_ERR_INVALID_STATE;
+
+    // Unpublish first: a submit either got in before (its item is failed by
+    // the task) or sees NULL
+    xSemaphoreTake(mb->async_lock, portMAX_DELAY);
+    mb_async_t *a = mb->async;
+    mb->async = NULL;
+    xSemaphoreGive(mb->async_lock);
+    if (!a) return ESP_OK;
+
+    static const mb_async_item_t stop_item = { .stop = true };
+    xQueueSendToFront(a->queue, &stop_item, portMAX_DELAY);
+    xSemaphoreTake(a->done, portMAX_DELAY);
+
+    vQueueDelete(a->queue);
+    vSemaphoreDelete(a->done);
+    free(a);
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_master_submit(modbus_rtu_t *mb, const modbus_rtu_async_req_t *req, TickType_t wait_ticks)
+{
+    if (!mb || mb->role != MB_ROLE_MASTER) return ESP_ERR_INVALID_STATE;
+    if (!req || !req->request_pdu || req->request_pdu_len < 1) return ESP_ERR_INVALID_ARG;
+    if (req->request_pdu_len > MODBUS_RTU_PDU_MAX) return ESP_ERR_INVALID_SIZE;
+
+    mb_async_item_t it;
+    it.req = *req;
+    it.req.request_pdu = NULL;
+    it.pdu_len = req->request_pdu_len;
+    memcpy(it.pdu, req->request_pdu, req->request_pdu_len);
+    it.stop = false;
+
+    // Held across the send so stop cannot delete the queue under it
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(mb->async_lock, portMAX_DELAY);
+    if (!mb->async) err = ESP_ERR_INVALID_STATE;
+    else if (xQueueSend(mb->async->queue, &it, wait_ticks) != pdTRUE) err = ESP_ERR_TIMEOUT;
+    xSemaphoreGive(mb->async_lock);
+    return err;
+}
@@ -0,0 +1,65 @@
+#include "modbus_rtu_internal.h"
+
+#define MB_BANK_SPINS 64
+
+// After a few spins the other side is probably a preempted task on this
+// core; sleeping one tick lets it run regardless of priority.
+static inline void mb_bank_backoff(unsigned *spins)
+{
+    if (++*spins < MB_BANK_SPINS) return;
+    *spins = 0;
+    vTaskDelay(1);
+}
+
+void mb_bank_write_begin(modbus_rtu_reg_bank_t *b)
+{
+    unsigned spins = 0;
+    for (;;) {
+        uint32_t s = __atomic_load_n(&b->seq, __ATOMIC_RELAXED);
+        if (!(s & 1) && __atomic_compare_exchange_n(&b->seq, &s, s + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) break;
+        mb_bank_backoff(&spins);
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);    // odd seq visible before any data store
+}
+
+void mb_bank_write_end(modbus_rtu_reg_bank_t *b)
+{
+    __atomic_store_n(&b->seq, b->seq + 1, __ATOMIC_RELEASE);
+}
+
+esp_err_t modbus_rtu_reg_bank_init(modbus_rtu_reg_bank_t *bank, uint16_t *storage, uint16_t count)
+{
+    if (!bank || !storage || count == 0) return ESP_ERR_INVALID_ARG;
+    bank->seq = 0;
+    bank->count = count;
+    bank->regs = storage;
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_reg_bank_write(modbus_rtu_reg_bank_t *bank, uint16_t offset, const uint16_t *src, uint16_t n)
+{
+    if (!bank || !src) return ESP_ERR_INVALID_ARG;
+    if ((uint32_t)offset + n > bank->count) return ESP_ERR_INVALID_SIZE;
+
+    mb_bank_write_begin(bank);
+    memcpy(&bank->regs[offset], src, n * sizeof(uint16_t));
+    mb_bank_write_end(bank);
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_reg_bank_read(modbus_rtu_reg_bank_t *bank, uint16_t offset, uint16_t *dst, uint16_t n)
+{
+    if (!bank || !dst) return ESP_ERR_INVALID_ARG;
+    if ((uint32_t)offset + n > bank->count) return ESP_ERR_INVALID_SIZE;
+
+    unsigned spins = 0;
+    for (;;) {
+        uint32_t s0 = __atomic_load_n(&bank->seq, __ATOMIC_ACQUIRE);
+        if (!(s0 & 1)) {
+            memcpy(dst, &bank->regs[offset], n * sizeof(uint16_t));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&bank->seq, __ATOMIC_RELAXED) == s0) return ESP_OK;
+        }
+        mb_bank_backoff(&spins);
+    }
+}
@@ -1,4 +1,27 @@
-#include "modbus_rtu.h"
+#include "modbus_rtu_internal.h"
+
+// Eight bytes at a time in a 64-bit word, byte i of the buffer = byte i of
+// the word (little-endian order, swapped on big-endian hosts).
+static inline uint64_t mb_load_le64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static inline void mb_store_le64(uint8_t *p, uint64_t v)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    memcpy(p, &v, sizeof(v));
+}
+
+#define MB_LO7 0x7F7F7F7F7F7F7F7FULL
+#define MB_LSB 0x0101010101010101ULL
 
 size_t modbus_rtu_bits_pack(const uint8_t *src_bits, size_t bit_count, uint8_t *out_bytes, size_t out_len)
 {
@@ -6,10 +29,18 @@ size_t modbus_rtu_bits_pack(const uint8_t *src_bits, size_t bit_count, uint8_t *
     size_t needed = (bit_count + 7) / 8;
     if (out_len < needed) return 0;
 
-    for (size_t i = 0; i < needed; ++i) out_bytes[i] = 0;
-
-    for (size_t i = 0; i < bit_count; ++i) {
-        if (src_bits[i]) out_bytes[i / 8] |= (1u << (i % 8));
+    size_t full = bit_count / 8;
+    for (size_t i = 0; i < full; ++i) {
+        uint64_t x = mb_load_le64(&src_bits[i * 8]);
+        x = (((x & MB_LO7) + MB_LO7) | x) >> 7 & MB_LSB;          // any non-zero byte -> 1
+        out_bytes[i] = (uint8_t)((x * 0x0102040810204080ULL) >> 56); // byte k's LSB -> bit 56 + k
+    }
+    if (full < needed) {
+        uint8_t b = 0;
+        for (size_t k = 0; k < bit_count % 8; ++k) {
+            if (src_bits[full * 8 + k]) b |= (uint8_t)(1u << k);
+        }
+        out_bytes[full] = b;
     }
     return needed;
 }
@@ -20,8 +51,38 @@ size_t modbus_rtu_bits_unpack(const uint8_t *src_bytes, size_t byte_count, uint8
     size_t bit_count = byte_count * 8;
     if (out_bits_len < bit_count) bit_count = out_bits_len;
 
-    for (size_t i = 0; i < bit_count; ++i) {
+    size_t full = bit_count / 8;
+    for (size_t i = 0; i < full; ++i) {
+        uint64_t x = (src_bytes[i] * MB_LSB) & 0x8040201008040201ULL; // bit k kept in byte k
+        mb_store_le64(&out_bits[i * 8], ((x + MB_LO7) >> 7) & MB_LSB);
+    }
+    for (size_t i = full * 8; i < bit_count; ++i) {
         out_bits[i] = (src_bytes[i / 8] >> (i % 8)) & 0x01;
     }
     return bit_count;
 }
+
+void mb_bits_copy(uint8_t *dst, size_t dst_off, const uint8_t *src, size_t src_off, size_t n)
+{
+    while (n) {
+        size_t take = n < 8 ? n : 8;
+
+        // gather up to 8 source bits
+        const uint8_t *sp = src + (src_off >> 3);
+        size_t s = src_off & 7;
+        unsigned v = sp[0] >> s;
+        if (take > 8 - s) v |= (unsigned)sp[1] << (8 - s);
+        unsigned mask = (1u << take) - 1;
+        v &= mask;
+
+        // merge them at the destination offset
+        uint8_t *dp = dst + (dst_off >> 3);
+        size_t d = dst_off & 7;
+        dp[0] = (uint8_t)((dp[0] & ~(mask << d)) | (v << d));
+        if (d + take > 8) dp[1] = (uint8_t)((dp[1] & ~(mask >> (8 - d))) | (v >> (8 - d)));
+
+        src_off += take;
+        dst_off += take;
+        n -= take;
+    }
+}
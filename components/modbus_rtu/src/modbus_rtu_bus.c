@@ -0,0 +1,135 @@
+#include "modbus_rtu_internal.h"
+
+#define MB_BUS_NONE 0xFF
+
+struct modbus_rtu_bus_mgr_s {
+    modbus_rtu_bus_mgr_config_t cfg;
+    modbus_rtu_t **buses;
+    int bus_count;
+    uint8_t unit_bus[256];      // MB_BUS_NONE = unmapped
+    QueueHandle_t results;
+    uint32_t dropped;
+};
+
+// Runs in the bus task of whichever segment completed the request
+static void mb_bus_collect(const modbus_rtu_async_result_t *res)
+{
+    modbus_rtu_bus_mgr_t *mgr = (modbus_rtu_bus_mgr_t*)res->mb->bus_mgr;
+    modbus_rtu_bus_result_t out = {
+        .bus = -1,
+        .err = res->err,
+        .unit_id = res->unit_id,
+        .ex = res->ex,
+        .user = res->user,
+    };
+    for (int i = 0; i < mgr->bus_count; ++i) {
+        if (mgr->buses[i] == res->mb) { out.bus = i; break; }
+    }
+    if (res->response_pdu && res->response_pdu_len <= sizeof(out.response_pdu)) {
+        memcpy(out.response_pdu, res->response_pdu, res->response_pdu_len);
+        out.response_pdu_len = res->response_pdu_len;
+    }
+    if (xQueueSend(mgr->results, &out, 0) != pdTRUE) __atomic_fetch_add(&mgr->dropped, 1, __ATOMIC_RELAXED);
+}
+
+esp_err_t modbus_rtu_bus_mgr_create(const modbus_rtu_bus_mgr_config_t *cfg, modbus_rtu_bus_mgr_t **out)
+{
+    if (!out) return ESP_ERR_INVALID_ARG;
+    if (cfg && cfg->max_buses >= MB_BUS_NONE) return ESP_ERR_INVALID_ARG;
+    *out = NULL;
+
+    modbus_rtu_bus_mgr_t *mgr = (modbus_rtu_bus_mgr_t*)calloc(1, sizeof(modbus_rtu_bus_mgr_t));
+    if (!mgr) return ESP_ERR_NO_MEM;
+
+    if (cfg) mgr->cfg = *cfg;
+    if (mgr->cfg.max_buses <= 0) mgr->cfg.max_buses = 4;
+    memset(mgr->unit_bus, MB_BUS_NONE, sizeof(mgr->unit_bus));
+
+    mgr->buses = (modbus_rtu_t**)calloc((size_t)mgr->cfg.max_buses, sizeof(modbus_rtu_t*));
+    if (mgr->cfg.result_queue_len > 0) {
+        mgr->results = xQueueCreate((UBaseType_t)mgr->cfg.result_queue_len, sizeof(modbus_rtu_bus_result_t));
+    }
+    if (!mgr->buses || (mgr->cfg.result_queue_len > 0 && !mgr->results)) {
+        modbus_rtu_bus_mgr_destroy(mgr);
+        return ESP_ERR_NO_MEM;
+    }
+
+    *out = mgr;
+    return ESP_OK;
+}
+
+void modbus_rtu_bus_mgr_destroy(modbus_rtu_bus_mgr_t *mgr)
+{
+    if (!mgr) return;
+    for (int i = 0; i < mgr->bus_count; ++i) modbus_rtu_destroy(mgr->buses[i]);  // stops the bus task
+    if (mgr->results) vQueueDelete(mgr->results);
+    free(mgr->buses);
+    free(mgr);
+}
+
+// Buses are only added during setup, before requests are submitted
+esp_err_t modbus_rtu_bus_mgr_add_bus(modbus_rtu_bus_mgr_t *mgr, modbus_rtu_t *mb,
+                                     const modbus_rtu_async_config_t *worker, int *out_bus)
+{
+    if (!mgr || !mb) return ESP_ERR_INVALID_ARG;
+    if (mb->role != MB_ROLE_MASTER || mb->async || mb->bus_mgr) return ESP_ERR_INVALID_STATE;
+    if (mgr->bus_count >= mgr->cfg.max_buses) return ESP_ERR_NO_MEM;
+
+    esp_err_t err = modbus_rtu_master_async_start(mb, worker);
+    if (err != ESP_OK) return err;
+
+    mb->bus_mgr = mgr;
+    int bus = mgr->bus_count;
+    mgr->buses[bus] = mb;
+    __atomic_store_n(&mgr->bus_count, bus + 1, __ATOMIC_RELEASE);
+    if (out_bus) *out_bus = bus;
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_bus_mgr_map_unit(modbus_rtu_bus_mgr_t *mgr, uint8_t unit_id, int bus)
+{
+    if (!mgr || unit_id == 0) return ESP_ERR_INVALID_ARG;
+    if (bus >= mgr->bus_count) return ESP_ERR_NOT_FOUND;
+    __atomic_store_n(&mgr->unit_bus[unit_id], (uint8_t)(bus < 0 ? MB_BUS_NONE : bus), __ATOMIC_RELAXED);
+    return ESP_OK;
+}
+
+modbus_rtu_t *modbus_rtu_bus_mgr_handle(modbus_rtu_bus_mgr_t *mgr, uint8_t unit_id)
+{
+    if (!mgr) return NULL;
+    uint8_t bus = __atomic_load_n(&mgr->unit_bus[unit_id], __ATOMIC_RELAXED);
+    return (bus == MB_BUS_NONE) ? NULL : mgr->buses[bus];
+}
+
+esp_err_t modbus_rtu_bus_mgr_submit_to(modbus_rtu_bus_mgr_t *mgr, int bus, const modbus_rtu_async_req_t *req,
+                                       TickType_t wait_ticks)
+{
+    if (!mgr || !req) return ESP_ERR_INVALID_ARG;
+    if (bus < 0 || bus >= __atomic_load_n(&mgr->bus_count, __ATOMIC_ACQUIRE)) return ESP_ERR_NOT_FOUND;
+
+    if (req->callback || !mgr->results) return modbus_rtu_master_submit(mgr->buses[bus], req, wait_ticks);
+
+    modbus_rtu_async_req_t r = *req;
+    r.callback = mb_bus_collect;
+    return modbus_rtu_master_submit(mgr->buses[bus], &r, wait_ticks);
+}
+
+esp_err_t modbus_rtu_bus_mgr_submit(modbus_rtu_bus_mgr_t *mgr, const modbus_rtu_async_req_t *req, TickType_t wait_ticks)
+{
+    if (!mgr || !req) return ESP_ERR_INVALID_ARG;
+    uint8_t bus = __atomic_load_n(&mgr->unit_bus[req->unit_id], __ATOMIC_RELAXED);
+    if (req->unit_id == 0 || bus == MB_BUS_NONE) return ESP_ERR_NOT_FOUND;
+    return modbus_rtu_bus_mgr_submit_to(mgr, bus, req, wait_ticks);
+}
+
+esp_err_t modbus_rtu_bus_mgr_get_result(modbus_rtu_bus_mgr_t *mgr, modbus_rtu_bus_result_t *out, TickType_t wait_ticks)
+{
+    if (!mgr || !out) return ESP_ERR_INVALID_ARG;
+    if (!mgr->results) return ESP_ERR_INVALID_STATE;
+    return (xQueueReceive(mgr->results, out, wait_ticks) == pdTRUE) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+uint32_t modbus_rtu_bus_mgr_dropped_results(const modbus_rtu_bus_mgr_t *mgr)
+{
+    return mgr ? __atomic_load_n(&mgr->dropped, __ATOMIC_RELAXED) : 0;
+}
@@ -0,0 +1,268 @@
+#include "modbus_rtu_internal.h"
+
+#define MB_CACHE_REGS_MAX 125
+#define MB_BIT_GET(bm, k) (((bm)[(k) / 32] >> ((k) % 32)) & 1u)
+
+typedef struct {
+    bool used;
+    uint8_t unit_id;
+    uint8_t fc;
+    uint16_t addr;
+    uint16_t count;
+    int64_t expires_us;
+    int64_t last_use_us;
+    uint16_t regs[MB_CACHE_REGS_MAX];
+} mb_cache_entry_t;
+
+typedef struct {
+    uint8_t unit_id;            // 0 = any
+    uint8_t fc;
+    uint16_t addr;
+    uint16_t count;
+    uint32_t ttl_ms;
+} mb_cache_rule_t;
+
+struct mb_cache_s {
+    modbus_rtu_cache_config_t cfg;
+    SemaphoreHandle_t lock;
+    mb_cache_entry_t *entries;
+    mb_cache_rule_t *rules;
+    size_t rule_count;
+    uint32_t gen;               // bumped by every invalidation
+    modbus_rtu_cache_stats_t stats;
+};
+
+static inline bool mb_overlaps(uint32_t a, uint32_t an, uint32_t b, uint32_t bn)
+{
+    return a < b + bn && b < a + an;
+}
+
+static uint32_t mb_cache_ttl_locked(const struct mb_cache_s *c, uint8_t unit_id, uint8_t fc,
+                                    uint16_t addr, uint16_t qty)
+{
+    uint32_t ttl = c->cfg.default_ttl_ms;
+    bool matched = false;
+    for (size_t i = 0; i < c->rule_count; ++i) {
+        const mb_cache_rule_t *r = &c->rules[i];
+        if (r->fc != fc || (r->unit_id && r->unit_id != unit_id)) continue;
+        if (!mb_overlaps(r->addr, r->count, addr, qty)) continue;
+        if (!matched || r->ttl_ms < ttl) ttl = r->ttl_ms;
+        matched = true;
+    }
+    return ttl;
+}
+
+static void mb_cache_drop_locked(struct mb_cache_s *c, uint8_t unit_id, uint8_t fc, uint16_t addr, uint32_t qty)
+{
+    for (size_t i = 0; i < c->cfg.max_entries; ++i) {
+        mb_cache_entry_t *e = &c->entries[i];
+        if (!e->used || e->fc != fc) continue;
+        if (unit_id && e->unit_id != unit_id) continue;
+        if (!mb_overlaps(e->addr, e->count, addr, qty)) continue;
+        e->used = false;
+        c->stats.invalidations++;
+    }
+}
+
+static void mb_cache_insert_locked(struct mb_cache_s *c, uint8_t unit_id, uint8_t fc, uint16_t addr,
+                                   uint16_t qty, const uint16_t *regs, int64_t now)
+{
+    uint32_t ttl = mb_cache_ttl_locked(c, unit_id, fc, addr, qty);
+    if (ttl == 0) return;
+
+    // Overlapping entries hold older data for part of this range
+    for (size_t i = 0; i < c->cfg.max_entries; ++i) {
+        mb_cache_entry_t *e = &c->entries[i];
+        if (e->used && e->unit_id == unit_id && e->fc == fc && mb_overlaps(e->addr, e->count, addr, qty)) e->used = false;
+    }
+
+    // Free or expired slot first, else least recently used
+    mb_cache_entry_t *victim = NULL;
+    for (size_t i = 0; i < c->cfg.max_entries; ++i) {
+        mb_cache_entry_t *e = &c->entries[i];
+        if (!e->used || e->expires_us <= now) { victim = e; break; }
+        if (!victim || e->last_use_us < victim->last_use_us) victim = e;
+    }
+    if (victim->used && victim->expires_us > now) c->stats.evictions++;
+
+    victim->used = true;
+    victim->unit_id = unit_id;
+    victim->fc = fc;
+    victim->addr = addr;
+    victim->count = qty;
+    victim->expires_us = now + (int64_t)ttl * 1000;
+    victim->last_use_us = now;
+    memcpy(victim->regs, regs, qty * sizeof(uint16_t));
+}
+
+esp_err_t mb_cache_read_regs(modbus_rtu_t *mb, uint8_t unit_id, uint8_t fc, uint16_t addr, uint16_t qty,
+                             uint16_t *out_regs, modbus_rtu_exception_t *ex)
+{
+    struct mb_cache_s *c = mb->cache;
+    uint32_t have[(MB_CACHE_REGS_MAX + 31) / 32] = {0};     // bit k: out_regs[k] filled from the cache
+    size_t have_count = 0;
+
+    xSemaphoreTake(c->lock, portMAX_DELAY);
+    int64_t now = mb_time_us();
+    for (size_t i = 0; i < c->cfg.max_entries && have_count < qty; ++i) {
+        mb_cache_entry_t *e = &c->entries[i];
+        if (!e->used || e->unit_id != unit_id || e->fc != fc || e->expires_us <= now) continue;
+        if (!mb_overlaps(e->addr, e->count, addr, qty)) continue;
+
+        uint32_t lo = (e->addr > addr) ? e->addr : addr;
+        uint32_t hi = (uint32_t)e->addr + e->count;
+        if (hi > (uint32_t)addr + qty) hi = (uint32_t)addr + qty;
+        for (uint32_t a = lo; a < hi; ++a) {
+            size_t k = a - addr;
+            if (MB_BIT_GET(have, k)) continue;
+            out_regs[k] = e->regs[a - e->addr];
+            have[k / 32] |= 1u << (k % 32);
+            have_count++;
+        }
+        e->last_use_us = now;
+    }
+
+    if (have_count == qty) {
+        c->stats.hits++;
+        xSemaphoreGive(c->lock);
+        if (ex) { ex->function = 0; ex->exception_code = 0; }
+        return ESP_OK;
+    }
+    if (have_count) c->stats.partial_hits++;
+    else c->stats.misses++;
+    uint32_t gen = c->gen;
+    xSemaphoreGive(c->lock);
+
+    // Fetch the span covering every missing register
+    size_t first = 0, last = qty - 1;
+    while (MB_BIT_GET(have, first)) first++;
+    while (MB_BIT_GET(have, last)) last--;
+    uint16_t span_addr = (uint16_t)(addr + first);
+    uint16_t span_qty = (uint16_t)(last - first + 1);
+
+    // Straight into the caller's buffer; cached registers inside the span
+    // are refreshed along with the missing ones
+    uint16_t *fetched = &out_regs[first];
+    esp_err_t err = mb_master_fetch_regs(mb, unit_id, fc, span_addr, span_qty, fetched, ex);
+    if (err != ESP_OK) return err;
+
+    xSemaphoreTake(c->lock, portMAX_DELAY);
+    // A write sent while we were on the bus may have changed the data
+    if (c->gen == gen) mb_cache_insert_locked(c, unit_id, fc, span_addr, span_qty, fetched, mb_time_us());
+    xSemaphoreGive(c->lock);
+    return ESP_OK;
+}
+
+void mb_cache_invalidate_pdu(struct mb_cache_s *c, uint8_t unit_id, const uint8_t *pdu, size_t pdu_len)
+{
+    uint16_t addr, qty;
+    switch (pdu[0]) {
+        case MB_FC_WRITE_SINGLE_REG:
+        case MB_FC_MASK_WRITE_REG:
+            if (pdu_len < 3) return;
+            addr = (uint16_t)((pdu[1] << 8) | pdu[2]);
+            qty = 1;
+            break;
+        case MB_FC_WRITE_MULTIPLE_REGS:
+            if (pdu_len < 5) return;
+            addr = (uint16_t)((pdu[1] << 8) | pdu[2]);
+            qty = (uint16_t)((pdu[3] << 8) | pdu[4]);
+            break;
+        case MB_FC_READWRITE_MULTIPLE_REGS:
+            if (pdu_len < 9) return;
+            addr = (uint16_t)((pdu[5] << 8) | pdu[6]);
+            qty = (uint16_t)((pdu[7] << 8) | pdu[8]);
+            break;
+        default:
+            return;
+    }
+    if (qty == 0) return;
+
+    xSemaphoreTake(c->lock, portMAX_DELAY);
+    c->gen++;
+    mb_cache_drop_locked(c, unit_id, MB_FC_READ_HOLDING_REGS, addr, qty);   // unit 0: broadcast hits all
+    xSemaphoreGive(c->lock);
+}
+
+esp_err_t modbus_rtu_master_cache_enable(modbus_rtu_t *mb, const modbus_rtu_cache_config_t *cfg)
+{
+    if (!mb || mb->role != MB_ROLE_MASTER) return ESP_ERR_INVALID_STATE;
+    if (mb->cache) return ESP_ERR_INVALID_STATE;
+
+    struct mb_cache_s *c = (struct mb_cache_s*)calloc(1, sizeof(struct mb_cache_s));
+    if (!c) return ESP_ERR_NO_MEM;
+
+    if (cfg) c->cfg = *cfg;
+    if (c->cfg.max_entries == 0) c->cfg.max_entries = 16;
+    if (c->cfg.default_ttl_ms == 0) c->cfg.default_ttl_ms = 1000;
+    if (c->cfg.max_ttl_rules == 0) c->cfg.max_ttl_rules = 8;
+
+    c->entries = (mb_cache_entry_t*)calloc(c->cfg.max_entries, sizeof(mb_cache_entry_t));
+    c->rules = (mb_cache_rule_t*)calloc(c->cfg.max_ttl_rules, sizeof(mb_cache_rule_t));
+    c->lock = xSemaphoreCreateMutex();
+    if (!c->entries || !c->rules || !c->lock) {
+        if (c->lock) vSemaphoreDelete(c->lock);
+        free(c->entries);
+        free(c->rules);
+        free(c);
+        return ESP_ERR_NO_MEM;
+    }
+
+    mb->cache = c;
+    return ESP_OK;
+}
+
+void modbus_rtu_master_cache_disable(modbus_rtu_t *mb)
+{
+    if (!mb || !mb->cache) return;
+    struct mb_cache_s *c = mb->cache;
+    mb->cache = NULL;
+    vSemaphoreDelete(c->lock);
+    free(c->entries);
+    free(c->rules);
+    free(c);
+}
+
+esp_err_t modbus_rtu_master_cache_set_ttl(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_table_t table,
+                                         uint16_t addr, uint16_t count, uint32_t ttl_ms)
+{
+    if (!mb || !mb->cache) return ESP_ERR_INVALID_STATE;
+    if (table != MODBUS_RTU_TABLE_HOLDING && table != MODBUS_RTU_TABLE_INPUT) return ESP_ERR_INVALID_ARG;
+    if (count == 0) return ESP_ERR_INVALID_ARG;
+
+    struct mb_cache_s *c = mb->cache;
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(c->lock, portMAX_DELAY);
+    if (c->rule_count >= c->cfg.max_ttl_rules) {
+        err = ESP_ERR_NO_MEM;
+    } else {
+        c->rules[c->rule_count++] = (mb_cache_rule_t){
+            .unit_id = unit_id, .fc = (uint8_t)table, .addr = addr, .count = count, .ttl_ms = ttl_ms,
+        };
+        // Entries cached under the old TTL would outlive the new one
+        mb_cache_drop_locked(c, unit_id, (uint8_t)table, addr, count);
+    }
+    xSemaphoreGive(c->lock);
+    return err;
+}
+
+void modbus_rtu_master_cache_invalidate(modbus_rtu_t *mb, uint8_t unit_id)
+{
+    if (!mb || !mb->cache) return;
+    struct mb_cache_s *c = mb->cache;
+    xSemaphoreTake(c->lock, portMAX_DELAY);
+    c->gen++;
+    mb_cache_drop_locked(c, unit_id, MB_FC_READ_HOLDING_REGS, 0, 0x10000);
+    mb_cache_drop_locked(c, unit_id, MB_FC_READ_INPUT_REGS, 0, 0x10000);
+    xSemaphoreGive(c->lock);
+}
+
+esp_err_t modbus_rtu_master_cache_get_stats(modbus_rtu_t *mb, modbus_rtu_cache_stats_t *out)
+{
+    if (!mb || !out) return ESP_ERR_INVALID_ARG;
+    if (!mb->cache) return ESP_ERR_INVALID_STATE;
+    xSemaphoreTake(mb->cache->lock, portMAX_DELAY);
+    *out = mb->cache->stats;
+    xSemaphoreGive(mb->cache->lock);
+    return ESP_OK;
+}
@@ -0,0 +1,139 @@
+#include "modbus_rtu_internal.h"
+
+#define MB_PCAP_LINKTYPE_USER0 147
+#define MB_CAP_PSEUDO_SIZE     8
+
+// Slot layout: header, then up to snap_len ADU bytes
+typedef struct {
+    int64_t t_us;
+    int32_t result;
+    uint16_t len;       // wire length
+    uint8_t dir;
+    uint8_t reserved;
+} mb_cap_hdr_t;
+
+_Static_assert(sizeof(mb_cap_hdr_t) == MODBUS_RTU_CAPTURE_HDR_SIZE, "capture header size");
+
+// Single writer: the task owning the bus (master mutex holder or slave task).
+// Record i lives in slot i % slots and is rewritten while head == i + slots.
+void mb_capture_record(modbus_rtu_capture_t *cap, uint8_t dir, const uint8_t *adu, size_t len, esp_err_t result)
+{
+    uint32_t h = cap->head;
+    uint8_t *slot = cap->buf + (size_t)(h % cap->slots) * cap->slot_size;
+    mb_cap_hdr_t hdr = {
+        .t_us = mb_time_us(),
+        .result = (int32_t)result,
+        .len = (uint16_t)len,
+        .dir = dir,
+    };
+    size_t n = len < cap->snap_len ? len : cap->snap_len;
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);    // head == h visible before the slot changes
+    memcpy(slot, &hdr, sizeof(hdr));
+    memcpy(slot + sizeof(hdr), adu, n);
+    __atomic_store_n(&cap->head, h + 1, __ATOMIC_RELEASE);
+}
+
+esp_err_t modbus_rtu_capture_init(modbus_rtu_capture_t *cap, void *buf, size_t buf_size, uint16_t snap_len)
+{
+    if (!cap || !buf || snap_len == 0 || snap_len > MODBUS_RTU_ADU_MAX) return ESP_ERR_INVALID_ARG;
+
+    size_t slot_size = MODBUS_RTU_CAPTURE_BUF_SIZE(1, snap_len);
+    size_t slots = buf_size / slot_size;
+    if (slots < 2) return ESP_ERR_INVALID_SIZE;
+    if (slots > UINT32_MAX / 2) slots = UINT32_MAX / 2;
+
+    cap->buf = (uint8_t*)buf;
+    cap->slot_size = slot_size;
+    cap->slots = (uint32_t)slots;
+    cap->snap_len = snap_len;
+    cap->role = 0;
+    cap->head = 0;
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_capture_attach(modbus_rtu_t *mb, modbus_rtu_capture_t *cap)
+{
+    if (!mb) return ESP_ERR_INVALID_ARG;
+    if (cap && !cap->buf) return ESP_ERR_INVALID_STATE;
+    if (cap) cap->role = (uint8_t)mb->role;
+    __atomic_store_n(&mb->port.cap, cap, __ATOMIC_RELEASE);
+    return ESP_OK;
+}
+
+void modbus_rtu_capture_clear(modbus_rtu_capture_t *cap)
+{
+    if (cap) __atomic_store_n(&cap->head, 0, __ATOMIC_RELEASE);
+}
+
+// The slot of the oldest record is the next one written, so a full ring
+// exposes slots - 1 records.
+size_t modbus_rtu_capture_count(const modbus_rtu_capture_t *cap)
+{
+    if (!cap || !cap->buf) return 0;
+    uint32_t h = __atomic_load_n(&cap->head, __ATOMIC_ACQUIRE);
+    return h < cap->slots ? h : cap->slots - 1;
+}
+
+static inline void mb_put_be16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)v; }
+
+static inline void mb_put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16); p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v;
+}
+
+esp_err_t modbus_rtu_capture_export_pcap(const modbus_rtu_capture_t *cap, modbus_rtu_capture_write_t write,
+                                         void *user, uint32_t *out_lost)
+{
+    if (!cap || !cap->buf || !write) return ESP_ERR_INVALID_ARG;
+    if (out_lost) *out_lost = 0;
+
+    // pcap headers in host byte order; readers detect it from the magic
+    struct {
+        uint32_t magic;
+        uint16_t version_major, version_minor;
+        int32_t thiszone;
+        uint32_t sigfigs, snaplen, network;
+    } file_hdr = { 0xA1B2C3D4u, 2, 4, 0, 0, (uint32_t)cap->snap_len + MB_CAP_PSEUDO_SIZE, MB_PCAP_LINKTYPE_USER0 };
+    esp_err_t err = write(&file_hdr, sizeof(file_hdr), user);
+    if (err != ESP_OK) return err;
+
+    struct {
+        uint32_t ts_sec, ts_usec, incl_len, orig_len;
+    } pkt_hdr;
+    uint8_t pkt[MB_CAP_PSEUDO_SIZE + MODBUS_RTU_ADU_MAX];
+
+    uint32_t h = __atomic_load_n(&cap->head, __ATOMIC_ACQUIRE);
+    uint32_t first = h < cap->slots ? 0 : h - cap->slots + 1;
+    uint32_t lost = 0;
+
+    for (uint32_t i = first; i != h; ++i) {
+        const uint8_t *slot = cap->buf + (size_t)(i % cap->slots) * cap->slot_size;
+        mb_cap_hdr_t hdr;
+        memcpy(&hdr, slot, sizeof(hdr));
+        size_t n = hdr.len < cap->snap_len ? hdr.len : cap->snap_len;
+        memcpy(pkt + MB_CAP_PSEUDO_SIZE, slot + sizeof(hdr), n);
+
+        // Rewritten by the writer while we copied it
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&cap->head, __ATOMIC_RELAXED) - i >= cap->slots) { lost++; continue; }
+
+        pkt[0] = hdr.dir;
+        pkt[1] = cap->role;
+        mb_put_be16(&pkt[2], hdr.len);
+        mb_put_be32(&pkt[4], (uint32_t)hdr.result);
+
+        int64_t t = hdr.t_us > 0 ? hdr.t_us : 0;
+        pkt_hdr.ts_sec = (uint32_t)(t / 1000000);
+        pkt_hdr.ts_usec = (uint32_t)(t % 1000000);
+        pkt_hdr.incl_len = (uint32_t)(MB_CAP_PSEUDO_SIZE + n);
+        pkt_hdr.orig_len = (uint32_t)(MB_CAP_PSEUDO_SIZE + hdr.len);
+
+        err = write(&pkt_hdr, sizeof(pkt_hdr), user);
+        if (err == ESP_OK) err = write(pkt, MB_CAP_PSEUDO_SIZE + n, user);
+        if (err != ESP_OK) return err;
+    }
+
+    if (out_lost) *out_lost = lost;
+    return ESP_OK;
+}
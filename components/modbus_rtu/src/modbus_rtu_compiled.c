@@ -0,0 +1,85 @@
+#include "modbus_rtu_internal.h"
+
+esp_err_t modbus_rtu_compile(uint8_t unit_id, const uint8_t *pdu, size_t pdu_len, modbus_rtu_compiled_t **out)
+{
+    if (!out) return ESP_ERR_INVALID_ARG;
+    *out = NULL;
+    if (!pdu || pdu_len < 1) return ESP_ERR_INVALID_ARG;
+    if (pdu_len > MODBUS_RTU_PDU_MAX) return ESP_ERR_NO_MEM;
+
+    size_t adu_len = 1 + pdu_len + 2;
+    modbus_rtu_compiled_t *c = (modbus_rtu_compiled_t*)malloc(sizeof(modbus_rtu_compiled_t) + adu_len);
+    if (!c) return ESP_ERR_NO_MEM;
+
+    c->adu[0] = unit_id;
+    memcpy(&c->adu[1], pdu, pdu_len);
+    uint16_t crc = modbus_rtu_crc16(c->adu, 1 + pdu_len);
+    c->adu[1 + pdu_len + 0] = (uint8_t)(crc & 0xFF);
+    c->adu[1 + pdu_len + 1] = (uint8_t)(crc >> 8);
+    c->adu_len = (uint16_t)adu_len;
+    c->rsp_len = (uint16_t)mb_expected_rsp_len(pdu, pdu_len);
+
+    *out = c;
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_compile_read(uint8_t unit_id, modbus_rtu_table_t table, uint16_t addr, uint16_t qty,
+                                  modbus_rtu_compiled_t **out)
+{
+    if (table < MODBUS_RTU_TABLE_COILS || table > MODBUS_RTU_TABLE_INPUT) return ESP_ERR_INVALID_ARG;
+    uint16_t max_qty = (table <= MODBUS_RTU_TABLE_DISCRETE_INPUTS) ? 2000 : 125;
+    if (qty < 1 || qty > max_qty) return ESP_ERR_INVALID_ARG;
+
+    uint8_t pdu[5] = {
+        (uint8_t)table,
+        (uint8_t)(addr >> 8), (uint8_t)(addr & 0xFF),
+        (uint8_t)(qty >> 8), (uint8_t)(qty & 0xFF),
+    };
+    return modbus_rtu_compile(unit_id, pdu, sizeof(pdu), out);
+}
+
+void modbus_rtu_compiled_free(modbus_rtu_compiled_t *req)
+{
+    free(req);
+}
+
+esp_err_t modbus_rtu_master_run_compiled(modbus_rtu_t *mb, const modbus_rtu_compiled_t *req, modbus_rtu_frame_t *rx,
+                                         const uint8_t **response_pdu, size_t *response_pdu_len,
+                                         modbus_rtu_exception_t *ex)
+{
+    if (!mb || mb->role != MB_ROLE_MASTER) return ESP_ERR_INVALID_STATE;
+    if (!req || !rx || !response_pdu || !response_pdu_len) return ESP_ERR_INVALID_ARG;
+    return mb_master_run_adu(mb, req->adu, req->adu_len, req->rsp_len, rx, response_pdu, response_pdu_len, ex);
+}
+
+esp_err_t modbus_rtu_master_run_batch(modbus_rtu_t *mb, const modbus_rtu_compiled_t *const *reqs, size_t count,
+                                      modbus_rtu_batch_cb_t cb, void *user)
+{
+    if (!mb || mb->role != MB_ROLE_MASTER) return ESP_ERR_INVALID_STATE;
+    if (!reqs && count > 0) return ESP_ERR_INVALID_ARG;
+    for (size_t i = 0; i < count; ++i) {
+        if (!reqs[i]) return ESP_ERR_INVALID_ARG;
+    }
+
+    mb_adapt_pending_t pending = {0};
+    modbus_rtu_frame_t rx = {0};
+    esp_err_t first_err = ESP_OK;
+
+    if (xSemaphoreTake(mb->master_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) return ESP_ERR_TIMEOUT;
+    for (size_t i = 0; i < count; ++i) {
+        const modbus_rtu_compiled_t *c = reqs[i];
+        const uint8_t *rsp = NULL;
+        size_t rsp_len = 0;
+        modbus_rtu_exception_t ex = {0};
+        int state;
+        esp_err_t err = mb_master_exchange(mb, c->adu, c->adu_len, c->rsp_len, &rx, &rsp, &rsp_len, &ex, &state);
+        if (err != ESP_OK && first_err == ESP_OK) first_err = err;
+        mb_adapt_defer(&pending, c->adu[0], state);
+        if (cb) cb(i, err, &ex, rsp, rsp_len, user);
+    }
+    xSemaphoreGive(mb->master_mutex);
+
+    // Adaptive state changes are reported once the bus is released
+    mb_adapt_flush(mb, &pending);
+    return first_err;
+}
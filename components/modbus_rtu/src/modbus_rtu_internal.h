@@ -5,15 +5,68 @@
 #include <string.h>
 
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 
-#include "esp_timer.h"
 #include "esp_log.h"
 
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#endif
+
+#ifndef CONFIG_MODBUS_RTU_LOG_LEVEL
+#define CONFIG_MODBUS_RTU_LOG_LEVEL 3
+#endif
+
+#if CONFIG_MODBUS_RTU_LOG_LEVEL >= 4
+#define MB_LOGD(...) ESP_LOGD(__VA_ARGS__)
+#else
+#define MB_LOGD(...)
+#endif
+#if CONFIG_MODBUS_RTU_LOG_LEVEL >= 3
+#define MB_LOGI(...) ESP_LOGI(__VA_ARGS__)
+#else
+#define MB_LOGI(...)
+#endif
+#if CONFIG_MODBUS_RTU_LOG_LEVEL >= 2
+#define MB_LOGW(...) ESP_LOGW(__VA_ARGS__)
+#else
+#define MB_LOGW(...)
+#endif
+#if CONFIG_MODBUS_RTU_LOG_LEVEL >= 1
+#define MB_LOGE(...) ESP_LOGE(__VA_ARGS__)
+#else
+#define MB_LOGE(...)
+#endif
+
 typedef enum { MB_ROLE_MASTER = 1, MB_ROLE_SLAVE = 2 } mb_role_t;
 
+#if CONFIG_MODBUS_RTU_STATS
 typedef struct {
+    modbus_rtu_unit_stats_t total;
+    uint32_t size_hist[MODBUS_RTU_SIZE_BUCKETS];
+    uint64_t tx_bytes;
+    uint64_t rx_bytes;
+    uint64_t busy_us;
+    int64_t since_us;
+    modbus_rtu_unit_stats_t *units[256];   // allocated on first use
+} mb_stats_t;
+#endif
+
+struct mb_async_s;
+struct mb_cache_s;
+struct mb_adapt_s;
+struct modbus_rtu_bus_mgr_s;
+
+typedef struct {
+    const modbus_rtu_transport_t *tp;
+    void *tp_ctx;
+
+    // built-in UART backend (tp_ctx == this port)
     uart_port_t uart_num;
     bool rs485_mode;
 
@@ -22,8 +75,29 @@ typedef struct {
 
     int txrx_turnaround_us;
     int inter_frame_timeout_us;
+
+    uint32_t char_time_us;
+    uint32_t t15_us;
+    uint32_t t35_us;
+    bool enforce_t15;
+
+    modbus_rtu_rx_mode_t rx_mode;
+    QueueHandle_t uart_queue;    // RX_EVENT only
+#if !CONFIG_IDF_TARGET_LINUX
+    esp_timer_handle_t gap_timer;   // enforce_t15: posts the end of the t1.5..t3.5 window
+    volatile uint32_t gap_seq;      // tags the window the timer event belongs to
+#endif
+
+    modbus_rtu_capture_t *cap;   // frame capture ring, NULL when off
 } mb_port_t;
 
+// One emulated slave device, indexed by unit id in modbus_rtu_s::units
+typedef struct {
+    modbus_rtu_slave_cb_t cb;
+    const modbus_rtu_data_model_t *model;
+    void *user_ctx;
+} mb_unit_t;
+
 struct modbus_rtu_s {
     mb_role_t role;
     mb_port_t port;
@@ -31,13 +105,40 @@ struct modbus_rtu_s {
     // master
     modbus_rtu_master_config_t master_cfg;
     SemaphoreHandle_t master_mutex;
+    int64_t bus_idle_at_us;         // no new request before this (broadcast turnaround)
+#if !CONFIG_IDF_TARGET_LINUX
+    esp_timer_handle_t idle_timer;  // one-shot, ends sub-tick waits for bus_idle_at_us
+    SemaphoreHandle_t idle_sem;     // given by idle_timer
+#endif
 
     // slave
     modbus_rtu_slave_config_t slave_cfg;
-    modbus_rtu_slave_cb_t cb;
-    void *user_ctx;
+    mb_unit_t *units[256];          // NULL = unit not served
+    SemaphoreHandle_t units_lock;   // held while a request is dispatched
     TaskHandle_t slave_task;
     volatile bool slave_running;
+
+    // static allocation (modbus_rtu_*_create_static)
+    bool static_alloc;              // handle lives in caller storage, never freed
+    modbus_rtu_slave_static_t *slave_static;  // RX buffer, task and stack
+    mb_unit_t static_unit;          // default unit of a static slave
+
+    // async master (modbus_rtu_async.c)
+    struct mb_async_s *async;
+    SemaphoreHandle_t async_lock;   // guards the async pointer for submit vs stop
+
+    // read cache (modbus_rtu_cache.c)
+    struct mb_cache_s *cache;
+
+    // adaptive timeouts / quarantine (modbus_rtu_adapt.c)
+    struct mb_adapt_s *adapt;
+
+    // owning bus manager, if any (modbus_rtu_bus.c)
+    struct modbus_rtu_bus_mgr_s *bus_mgr;
+
+#if CONFIG_MODBUS_RTU_STATS
+    mb_stats_t stats;               // modbus_rtu_stats.c
+#endif
 };
 
 #define MB_ADU_MAX_DEFAULT 256
@@ -65,10 +166,39 @@ enum {
     MB_EX_SLAVE_DEVICE_FAIL   = 0x04,
 };
 
+#if CONFIG_IDF_TARGET_LINUX
+static inline int64_t mb_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static inline void mb_delay_us(uint32_t us)
+{
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = (long)us * 1000 };
+    nanosleep(&ts, NULL);
+}
+#else
 static inline int64_t mb_time_us(void) { return esp_timer_get_time(); }
+static inline void mb_delay_us(uint32_t us) { esp_rom_delay_us(us); }
+
+extern const modbus_rtu_transport_t mb_uart_transport;
+#endif
+
+// Waits for a point in time: whole ticks while more than MB_SPIN_MAX_US is
+// left, a busy-wait only for the rest. A tick wait can end up to one tick late.
+#define MB_SPIN_MAX_US 500
+
+static inline TickType_t mb_ticks_ceil(int64_t us)
+{
+    const int64_t tick_us = (int64_t)portTICK_PERIOD_MS * 1000;
+    return (TickType_t)((us + tick_us - 1) / tick_us);
+}
 
+// inter_frame_timeout_us <= 0 selects t3.5 for the configured line
 esp_err_t mb_port_init(mb_port_t *p, const modbus_rtu_uart_config_t *uart_cfg,
-                       int inter_frame_timeout_us, int txrx_turnaround_us);
+                       int inter_frame_timeout_us, int txrx_turnaround_us, bool enforce_t15);
 
 void      mb_port_deinit(mb_port_t *p);
 
@@ -76,3 +206,95 @@ esp_err_t mb_port_write_adu(mb_port_t *p, const uint8_t *adu, size_t adu_len);
 
 esp_err_t mb_port_read_frame(mb_port_t *p, uint8_t *buf, size_t buf_len,
                              size_t *out_len, int overall_timeout_ms);
+
+// As mb_port_read_frame(), but the frame may end once predict() says it is
+// complete. *early is set when it did: the line has not been idle for t3.5.
+esp_err_t mb_port_read_frame_expect(mb_port_t *p, uint8_t *buf, size_t buf_len, size_t *out_len,
+                                    int overall_timeout_ms, modbus_rtu_frame_len_fn_t predict, void *arg,
+                                    bool *early);
+
+// Frame capture (modbus_rtu_capture.c), called by the port for every frame
+void mb_capture_record(modbus_rtu_capture_t *cap, uint8_t dir, const uint8_t *adu, size_t len, esp_err_t result);
+
+// Master engine (modbus_rtu.c)
+// Wraps the PDU already in place with unit id (headroom) and CRC (tailroom)
+void      mb_frame_seal(modbus_rtu_frame_t *f, uint8_t unit_id, size_t pdu_len);
+// Response ADU length implied by a request PDU, 0 if it cannot be known
+size_t    mb_expected_rsp_len(const uint8_t *pdu, size_t pdu_len);
+// Sends a sealed ADU and reads the response into rx, with master_mutex held.
+// tx may point into rx->adu. rsp_len != 0 is the only accepted length of a
+// normal response. *state gets an adaptive-timeout state change, else -1.
+esp_err_t mb_master_exchange(modbus_rtu_t *mb, const uint8_t *tx, size_t tx_len, size_t rsp_len,
+                             modbus_rtu_frame_t *rx, const uint8_t **response_pdu, size_t *response_pdu_len,
+                             modbus_rtu_exception_t *ex, int *state);
+// mb_master_exchange() under the mutex, then state notification
+esp_err_t mb_master_run_adu(modbus_rtu_t *mb, const uint8_t *tx, size_t tx_len, size_t rsp_len,
+                            modbus_rtu_frame_t *rx, const uint8_t **response_pdu, size_t *response_pdu_len,
+                            modbus_rtu_exception_t *ex);
+
+// Compiled request (modbus_rtu_compiled.c)
+struct modbus_rtu_compiled_s {
+    uint16_t rsp_len;           // expected response ADU length, 0 = not fixed
+    uint16_t adu_len;
+    uint8_t adu[];              // unit id, PDU, CRC
+};
+
+// Data model (modbus_rtu_model.c)
+esp_err_t mb_model_validate(const modbus_rtu_data_model_t *m);
+
+// Region of `table` that holds [addr, addr + qty) entirely, NULL if none
+const modbus_rtu_region_t *mb_model_find(const modbus_rtu_data_model_t *m, uint8_t table,
+                                         uint16_t addr, uint16_t qty);
+
+// Copy n packed bits (LSB first) between arbitrary bit offsets
+void mb_bits_copy(uint8_t *dst, size_t dst_off, const uint8_t *src, size_t src_off, size_t n);
+
+// Read cache (modbus_rtu_cache.c)
+esp_err_t mb_master_fetch_regs(modbus_rtu_t *mb, uint8_t unit_id, uint8_t fc, uint16_t addr, uint16_t qty,
+                               uint16_t *out_regs, modbus_rtu_exception_t *ex);
+esp_err_t mb_cache_read_regs(modbus_rtu_t *mb, uint8_t unit_id, uint8_t fc, uint16_t addr, uint16_t qty,
+                             uint16_t *out_regs, modbus_rtu_exception_t *ex);
+// Drops entries a write request PDU is about to change
+void      mb_cache_invalidate_pdu(struct mb_cache_s *c, uint8_t unit_id, const uint8_t *pdu, size_t pdu_len);
+
+// Adaptive timeouts (modbus_rtu_adapt.c), begin/end with master_mutex held.
+// begin picks the response timeout (rsp_len: expected response ADU length,
+// 0 = unknown) or refuses a quarantined unit; end
+// returns the new modbus_rtu_unit_state_t on a change, else -1, to be passed
+// to notify once the mutex is released.
+esp_err_t mb_adapt_begin(modbus_rtu_t *mb, uint8_t unit_id, size_t rsp_len, int *timeout_ms);
+int       mb_adapt_end(modbus_rtu_t *mb, uint8_t unit_id, esp_err_t err, size_t rx_len, int64_t elapsed_us);
+void      mb_adapt_notify(modbus_rtu_t *mb, uint8_t unit_id, int state);
+
+// State changes collected over several exchanges under one mutex hold and
+// notified after release: net change per unit and where it ended up
+typedef struct {
+    uint32_t changed[8];
+    uint32_t quarantined[8];
+} mb_adapt_pending_t;
+
+void      mb_adapt_defer(mb_adapt_pending_t *pd, uint8_t unit_id, int state);
+void      mb_adapt_flush(modbus_rtu_t *mb, const mb_adapt_pending_t *pd);
+
+// Register bank (modbus_rtu_bank.c): writer side for the slave engine
+void mb_bank_write_begin(modbus_rtu_reg_bank_t *b);
+void mb_bank_write_end(modbus_rtu_reg_bank_t *b);
+
+// Statistics (modbus_rtu_stats.c). unit_id 0 updates the handle totals only;
+// latency_us < 0 is not recorded.
+#if CONFIG_MODBUS_RTU_STATS
+void mb_stats_init(modbus_rtu_t *mb);
+void mb_stats_free(modbus_rtu_t *mb);
+void mb_stats_request(modbus_rtu_t *mb, uint8_t unit_id);
+void mb_stats_frame(modbus_rtu_t *mb, size_t tx_len, size_t rx_len);
+void mb_stats_result(modbus_rtu_t *mb, uint8_t unit_id, esp_err_t err, uint8_t ex_code, int64_t latency_us);
+#else
+static inline void mb_stats_init(modbus_rtu_t *mb) { (void)mb; }
+static inline void mb_stats_free(modbus_rtu_t *mb) { (void)mb; }
+static inline void mb_stats_request(modbus_rtu_t *mb, uint8_t unit_id) { (void)mb; (void)unit_id; }
+static inline void mb_stats_frame(modbus_rtu_t *mb, size_t tx_len, size_t rx_len) { (void)mb; (void)tx_len; (void)rx_len; }
+static inline void mb_stats_result(modbus_rtu_t *mb, uint8_t unit_id, esp_err_t err, uint8_t ex_code, int64_t latency_us)
+{
+    (void)mb; (void)unit_id; (void)err; (void)ex_code; (void)latency_us;
+}
+#endif
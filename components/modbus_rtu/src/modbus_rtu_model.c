@@ -0,0 +1,54 @@
+#include "modbus_rtu_internal.h"
+
+static const modbus_rtu_region_table_t *mb_model_table(const modbus_rtu_data_model_t *m, uint8_t table)
+{
+    switch (table) {
+        case MODBUS_RTU_TABLE_COILS:           return &m->coils;
+        case MODBUS_RTU_TABLE_DISCRETE_INPUTS: return &m->discrete_inputs;
+        case MODBUS_RTU_TABLE_HOLDING:         return &m->holding;
+        case MODBUS_RTU_TABLE_INPUT:           return &m->input;
+        default:                               return NULL;
+    }
+}
+
+esp_err_t mb_model_validate(const modbus_rtu_data_model_t *m)
+{
+    if (!m) return ESP_OK;
+    for (uint8_t t = MODBUS_RTU_TABLE_COILS; t <= MODBUS_RTU_TABLE_INPUT; ++t) {
+        const modbus_rtu_region_table_t *tb = mb_model_table(m, t);
+        if (tb->count && !tb->regions) return ESP_ERR_INVALID_ARG;
+        uint32_t next = 0;
+        for (size_t i = 0; i < tb->count; ++i) {
+            const modbus_rtu_region_t *r = &tb->regions[i];
+            if (r->count == 0 || r->start < next) return ESP_ERR_INVALID_ARG;  // empty, unsorted or overlapping
+            if (r->bank) {
+                if (r->storage || r->bank->count < r->count) return ESP_ERR_INVALID_ARG;
+                if (t == MODBUS_RTU_TABLE_COILS || t == MODBUS_RTU_TABLE_DISCRETE_INPUTS) return ESP_ERR_INVALID_ARG;
+            }
+            next = (uint32_t)r->start + r->count;
+            if (next > 0x10000) return ESP_ERR_INVALID_ARG;
+        }
+    }
+    return ESP_OK;
+}
+
+const modbus_rtu_region_t *mb_model_find(const modbus_rtu_data_model_t *m, uint8_t table,
+                                         uint16_t addr, uint16_t qty)
+{
+    if (!m) return NULL;
+    const modbus_rtu_region_table_t *tb = mb_model_table(m, table);
+    if (!tb || !tb->count) return NULL;
+
+    // last region with start <= addr
+    size_t lo = 0, hi = tb->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (tb->regions[mid].start <= addr) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0) return NULL;
+
+    const modbus_rtu_region_t *r = &tb->regions[lo - 1];
+    if ((uint32_t)addr + qty > (uint32_t)r->start + r->count) return NULL;
+    return r;
+}
@@ -0,0 +1,182 @@
+#include "modbus_rtu_internal.h"
+
+typedef struct {
+    uint8_t unit_id;
+    uint8_t table;
+    uint16_t addr;
+    uint16_t count;
+    uint16_t first;     // index into order[]
+    uint16_t n;
+} mb_plan_frame_t;
+
+struct modbus_rtu_read_plan_s {
+    modbus_rtu_read_req_t *reqs;
+    size_t req_count;
+    uint16_t *order;    // request indices sorted by unit/table/addr
+    mb_plan_frame_t *frames;
+    size_t frame_count;
+};
+
+static inline bool mb_table_is_bits(uint8_t table)
+{
+    return table == MODBUS_RTU_TABLE_COILS || table == MODBUS_RTU_TABLE_DISCRETE_INPUTS;
+}
+
+static int mb_plan_cmp(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+esp_err_t modbus_rtu_read_plan_build(const modbus_rtu_plan_config_t *cfg,
+                                     modbus_rtu_read_req_t *reqs, size_t req_count,
+                                     modbus_rtu_read_plan_t **out)
+{
+    if (!reqs || req_count == 0 || req_count > UINT16_MAX || !out) return ESP_ERR_INVALID_ARG;
+    *out = NULL;
+
+    modbus_rtu_plan_config_t c = {0};
+    if (cfg) c = *cfg;
+
+    for (size_t i = 0; i < req_count; ++i) {
+        const modbus_rtu_read_req_t *r = &reqs[i];
+        uint32_t limit = mb_table_is_bits(r->table) ? 2000 : 125;
+        if (r->table < MODBUS_RTU_TABLE_COILS || r->table > MODBUS_RTU_TABLE_INPUT) return ESP_ERR_INVALID_ARG;
+        if (r->unit_id == 0 || !r->dest || r->count < 1 || r->count > limit) return ESP_ERR_INVALID_ARG;
+        if ((uint32_t)r->addr + r->count > 0x10000) return ESP_ERR_INVALID_ARG;
+    }
+
+    modbus_rtu_read_plan_t *p = (modbus_rtu_read_plan_t*)calloc(1, sizeof(modbus_rtu_read_plan_t));
+    if (!p) return ESP_ERR_NO_MEM;
+    p->reqs = reqs;
+    p->req_count = req_count;
+    p->order = (uint16_t*)malloc(req_count * sizeof(uint16_t));
+    p->frames = (mb_plan_frame_t*)malloc(req_count * sizeof(mb_plan_frame_t)); // worst case: no merging
+    if (!p->order || !p->frames) { modbus_rtu_read_plan_free(p); return ESP_ERR_NO_MEM; }
+
+    // Sort key: unit | table | addr | longest first | request index
+    uint64_t *keys = (uint64_t*)malloc(req_count * sizeof(uint64_t));
+    if (!keys) { modbus_rtu_read_plan_free(p); return ESP_ERR_NO_MEM; }
+    for (size_t i = 0; i < req_count; ++i) {
+        const modbus_rtu_read_req_t *r = &reqs[i];
+        keys[i] = ((uint64_t)r->unit_id << 56) | ((uint64_t)r->table << 48) | ((uint64_t)r->addr << 32) |
+                  ((uint64_t)(uint16_t)~r->count << 16) | (uint64_t)i;
+    }
+    qsort(keys, req_count, sizeof(uint64_t), mb_plan_cmp);
+    for (size_t i = 0; i < req_count; ++i) p->order[i] = (uint16_t)(keys[i] & 0xFFFF);
+    free(keys);
+
+    // Greedy over requests sorted by start address: extend the open frame
+    // while the next request starts within the gap tolerance and the frame
+    // stays within the protocol limit.
+    mb_plan_frame_t *f = NULL;
+    uint32_t f_end = 0;
+    for (size_t k = 0; k < req_count; ++k) {
+        const modbus_rtu_read_req_t *r = &reqs[p->order[k]];
+        bool bits = mb_table_is_bits(r->table);
+        uint32_t limit = bits ? 2000 : 125;
+        uint32_t gap = bits ? c.max_gap_bits : c.max_gap_regs;
+        uint32_t r_end = (uint32_t)r->addr + r->count;
+
+        if (f && f->unit_id == r->unit_id && f->table == r->table &&
+            r->addr <= f_end + gap && (r_end > f_end ? r_end : f_end) - f->addr <= limit) {
+            if (r_end > f_end) f_end = r_end;
+            f->count = (uint16_t)(f_end - f->addr);
+            f->n++;
+            continue;
+        }
+
+        f = &p->frames[p->frame_count++];
+        f->unit_id = r->unit_id;
+        f->table = (uint8_t)r->table;
+        f->addr = r->addr;
+        f->count = r->count;
+        f->first = (uint16_t)k;
+        f->n = 1;
+        f_end = r_end;
+    }
+
+    *out = p;
+    return ESP_OK;
+}
+
+// Reads one frame and scatters it into requests order[first .. first+n)
+static esp_err_t mb_plan_read(modbus_rtu_t *mb, modbus_rtu_read_plan_t *p, uint8_t unit_id, uint8_t table,
+                              uint16_t addr, uint16_t count, size_t first, size_t n)
+{
+    modbus_rtu_frame_t f;
+    uint8_t *req = modbus_rtu_frame_pdu(&f);
+    req[0] = table;
+    req[1] = (uint8_t)(addr >> 8);
+    req[2] = (uint8_t)(addr & 0xFF);
+    req[3] = (uint8_t)(count >> 8);
+    req[4] = (uint8_t)(count & 0xFF);
+
+    const uint8_t *rsp = NULL;
+    size_t rsp_len = 0;
+    modbus_rtu_exception_t ex = {0};
+    bool bits = mb_table_is_bits(table);
+    size_t byte_count = bits ? (count + 7u) / 8u : count * 2u;
+
+    esp_err_t err = modbus_rtu_master_transaction_frame(mb, unit_id, &f, 5, &rsp, &rsp_len, &ex);
+    if (err == ESP_OK && (!rsp || rsp_len != 2 + byte_count || rsp[0] != table || rsp[1] != byte_count)) {
+        err = ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    }
+
+    for (size_t k = first; k < first + n; ++k) {
+        modbus_rtu_read_req_t *r = &p->reqs[p->order[k]];
+        r->err = err;
+        r->ex = ex;
+        if (err != ESP_OK) continue;
+
+        size_t off = r->addr - addr;
+        if (bits) {
+            uint8_t *dst = (uint8_t*)r->dest;
+            for (size_t i = 0; i < r->count; ++i) {
+                size_t b = off + i;
+                dst[i] = (rsp[2 + b / 8] >> (b % 8)) & 0x01;
+            }
+        } else {
+            uint16_t *dst = (uint16_t*)r->dest;
+            const uint8_t *src = &rsp[2 + off * 2];
+            for (size_t i = 0; i < r->count; ++i) dst[i] = (uint16_t)((src[i * 2] << 8) | src[i * 2 + 1]);
+        }
+    }
+    return err;
+}
+
+esp_err_t modbus_rtu_read_plan_execute(modbus_rtu_t *mb, modbus_rtu_read_plan_t *p)
+{
+    if (!mb || !p) return ESP_ERR_INVALID_ARG;
+
+    esp_err_t first_err = ESP_OK;
+    for (size_t i = 0; i < p->frame_count; ++i) {
+        const mb_plan_frame_t *f = &p->frames[i];
+        esp_err_t err = mb_plan_read(mb, p, f->unit_id, f->table, f->addr, f->count, f->first, f->n);
+
+        if (err == ESP_ERR_MODBUS_RTU_EXCEPTION && f->n > 1 &&
+            p->reqs[p->order[f->first]].ex.exception_code == MB_EX_ILLEGAL_DATA_ADDR) {
+            err = ESP_OK;
+            for (size_t k = f->first; k < (size_t)f->first + f->n; ++k) {
+                const modbus_rtu_read_req_t *r = &p->reqs[p->order[k]];
+                esp_err_t e = mb_plan_read(mb, p, r->unit_id, (uint8_t)r->table, r->addr, r->count, k, 1);
+                if (err == ESP_OK) err = e;
+            }
+        }
+        if (first_err == ESP_OK) first_err = err;
+    }
+    return first_err;
+}
+
+size_t modbus_rtu_read_plan_frame_count(const modbus_rtu_read_plan_t *p)
+{
+    return p ? p->frame_count : 0;
+}
+
+void modbus_rtu_read_plan_free(modbus_rtu_read_plan_t *p)
+{
+    if (!p) return;
+    free(p->order);
+    free(p->frames);
+    free(p);
+}
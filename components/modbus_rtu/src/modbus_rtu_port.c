@@ -0,0 +1,93 @@
+#include "modbus_rtu_internal.h"
+
+// Transport-independent part of the port: resolve timing, pick the backend
+// and forward frames to it.
+
+esp_err_t mb_port_init(mb_port_t *p, const modbus_rtu_uart_config_t *uart_cfg,
+                       int inter_frame_timeout_us, int txrx_turnaround_us, bool enforce_t15)
+{
+    if (!p || !uart_cfg) return ESP_ERR_INVALID_ARG;
+
+    modbus_rtu_timing_t timing;
+    esp_err_t err = modbus_rtu_calc_timing(uart_cfg, &timing);
+    if (err != ESP_OK) return err;
+    if (inter_frame_timeout_us > 0) timing.inter_frame_timeout_us = (uint32_t)inter_frame_timeout_us;
+
+    p->txrx_turnaround_us = (txrx_turnaround_us < 0) ? 0 : txrx_turnaround_us;
+    p->inter_frame_timeout_us = (int)timing.inter_frame_timeout_us;
+    p->char_time_us = timing.char_time_us;
+    p->t15_us = timing.t15_us;
+    p->t35_us = timing.t35_us;
+    p->enforce_t15 = enforce_t15;
+
+    p->tp = uart_cfg->transport;
+    p->tp_ctx = uart_cfg->transport_ctx;
+    if (!p->tp) {
+#if CONFIG_IDF_TARGET_LINUX
+        return ESP_ERR_NOT_SUPPORTED;
+#else
+        p->tp = &mb_uart_transport;
+        p->tp_ctx = p;
+#endif
+    }
+    if (!p->tp->init || !p->tp->write_adu || !p->tp->read_frame) return ESP_ERR_INVALID_ARG;
+
+    modbus_rtu_transport_params_t params = {
+        .uart = uart_cfg,
+        .timing = timing,
+        .txrx_turnaround_us = p->txrx_turnaround_us,
+        .enforce_t15 = enforce_t15,
+    };
+    return p->tp->init(p->tp_ctx, &params);
+}
+
+void mb_port_deinit(mb_port_t *p)
+{
+    if (!p || !p->tp) return;
+    if (p->tp->deinit) p->tp->deinit(p->tp_ctx);
+}
+
+esp_err_t mb_port_write_adu(mb_port_t *p, const uint8_t *adu, size_t adu_len)
+{
+    if (!p || !adu || adu_len == 0) return ESP_ERR_INVALID_ARG;
+    esp_err_t err = p->tp->write_adu(p->tp_ctx, adu, adu_len);
+    modbus_rtu_capture_t *cap = __atomic_load_n(&p->cap, __ATOMIC_ACQUIRE);
+    if (cap) mb_capture_record(cap, MODBUS_RTU_CAPTURE_TX, adu, adu_len, err);
+    return err;
+}
+
+static void mb_port_capture_rx(mb_port_t *p, const uint8_t *buf, size_t len, esp_err_t err)
+{
+    modbus_rtu_capture_t *cap = __atomic_load_n(&p->cap, __ATOMIC_ACQUIRE);
+    if (cap && (len || (err != ESP_ERR_MODBUS_RTU_TIMEOUT && err != ESP_ERR_TIMEOUT))) {
+        mb_capture_record(cap, MODBUS_RTU_CAPTURE_RX, buf, len, err);
+    }
+}
+
+esp_err_t mb_port_read_frame(mb_port_t *p, uint8_t *buf, size_t buf_len,
+                             size_t *out_len, int overall_timeout_ms)
+{
+    if (!p || !buf || !out_len || buf_len < 5) return ESP_ERR_INVALID_ARG;
+    *out_len = 0;
+    esp_err_t err = p->tp->read_frame(p->tp_ctx, buf, buf_len, out_len, overall_timeout_ms);
+    mb_port_capture_rx(p, buf, *out_len, err);
+    return err;
+}
+
+esp_err_t mb_port_read_frame_expect(mb_port_t *p, uint8_t *buf, size_t buf_len, size_t *out_len,
+                                    int overall_timeout_ms, modbus_rtu_frame_len_fn_t predict, void *arg,
+                                    bool *early)
+{
+    *early = false;
+    if (!p || !p->tp->read_frame_expect || !predict) return mb_port_read_frame(p, buf, buf_len, out_len, overall_timeout_ms);
+    if (!buf || !out_len || buf_len < 5) return ESP_ERR_INVALID_ARG;
+
+    *out_len = 0;
+    esp_err_t err = p->tp->read_frame_expect(p->tp_ctx, buf, buf_len, out_len, overall_timeout_ms, predict, arg);
+    if (err == ESP_OK) {
+        size_t n = predict(buf, *out_len, arg);
+        *early = n && *out_len >= n;
+    }
+    mb_port_capture_rx(p, buf, *out_len, err);
+    return err;
+}
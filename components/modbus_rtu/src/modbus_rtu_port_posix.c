@@ -0,0 +1,231 @@
+#include "modbus_rtu_internal.h"
+#include "modbus_rtu_port_posix.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+static const char *TAG = "mb_port_posix";
+
+// The FreeRTOS POSIX simulator runs one task at a time and a blocking
+// syscall stops all of them, so waits go to vTaskDelay() in whole ticks and
+// only a sub-tick rest blocks the thread. vTaskDelay(n) returns within n
+// ticks, never after the point in time.
+#define TICK_US ((int64_t)portTICK_PERIOD_MS * 1000)
+
+static void sleep_sub_tick(int64_t us)
+{
+    if (us <= 0) return;
+    struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (long)(us % 1000000) * 1000 };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) { }
+}
+
+static void sleep_until(int64_t t_us)
+{
+    for (;;) {
+        int64_t left = t_us - mb_time_us();
+        if (left <= 0) return;
+        if (left < TICK_US) { sleep_sub_tick(left); return; }
+        vTaskDelay((TickType_t)(left / TICK_US));
+    }
+}
+
+static void sleep_us(int64_t us)
+{
+    if (us > 0) sleep_until(mb_time_us() + us);
+}
+
+// Readable within wait_us (< 0: no limit)? Polls once a tick and blocks in
+// poll() only for a sub-tick rest.
+static int wait_readable(int fd, int64_t wait_us)
+{
+    const int64_t until = wait_us >= 0 ? mb_time_us() + wait_us : -1;
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    for (;;) {
+        int r = poll(&pfd, 1, 0);
+        if (r != 0) return r;
+        int64_t left = until >= 0 ? until - mb_time_us() : TICK_US;
+        if (left <= 0) return 0;
+        if (left >= TICK_US) {
+            vTaskDelay(1);
+            continue;
+        }
+        struct timespec ts = { .tv_sec = 0, .tv_nsec = (long)left * 1000 };
+        return ppoll(&pfd, 1, &ts, NULL);
+    }
+}
+
+static esp_err_t set_raw_nonblock(int fd)
+{
+    if (isatty(fd)) {
+        struct termios tio;
+        if (tcgetattr(fd, &tio) != 0) return ESP_ERR_MODBUS_RTU_PORT;
+        cfmakeraw(&tio);
+        if (tcsetattr(fd, TCSANOW, &tio) != 0) return ESP_ERR_MODBUS_RTU_PORT;
+    }
+    int fl = fcntl(fd, F_GETFL);
+    if (fl < 0 || fcntl(fd, F_SETFL, fl | O_NONBLOCK) < 0) return ESP_ERR_MODBUS_RTU_PORT;
+    return ESP_OK;
+}
+
+static void rx_drain(int fd)
+{
+    uint8_t junk[64];
+    while (read(fd, junk, sizeof(junk)) > 0) { }
+}
+
+static esp_err_t posix_init(void *ctx, const modbus_rtu_transport_params_t *params)
+{
+    modbus_rtu_posix_port_t *pp = (modbus_rtu_posix_port_t*)ctx;
+    if (!pp || pp->fd < 0) return ESP_ERR_INVALID_ARG;
+
+    pp->char_time_us = params->timing.char_time_us;
+    pp->inter_frame_timeout_us = params->timing.inter_frame_timeout_us;
+    pp->txrx_turnaround_us = params->txrx_turnaround_us;
+
+    esp_err_t err = set_raw_nonblock(pp->fd);
+    if (err != ESP_OK) { ESP_LOGE(TAG, "fd %d setup: %s", pp->fd, strerror(errno)); return err; }
+
+    rx_drain(pp->fd);
+    return ESP_OK;
+}
+
+static void posix_deinit(void *ctx)
+{
+    (void)ctx;
+}
+
+static esp_err_t posix_write_adu(void *ctx, const uint8_t *adu, size_t adu_len)
+{
+    modbus_rtu_posix_port_t *pp = (modbus_rtu_posix_port_t*)ctx;
+
+    rx_drain(pp->fd);
+    sleep_us(pp->txrx_turnaround_us);
+
+    // The peer sees the frame when its last character would have landed
+    if (pp->pace) sleep_us((int64_t)adu_len * pp->char_time_us);
+
+    size_t off = 0;
+    while (off < adu_len) {
+        ssize_t w = write(pp->fd, adu + off, adu_len - off);
+        if (w > 0) { off += (size_t)w; continue; }
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0 && errno == EAGAIN) {
+            vTaskDelay(1);
+            continue;
+        }
+        return ESP_ERR_MODBUS_RTU_PORT;
+    }
+
+    sleep_us(pp->txrx_turnaround_us);
+    return ESP_OK;
+}
+
+// Same contract as the UART backend: once data has arrived, the frame ends
+// after inter_frame_timeout_us without further bytes, or as soon as the
+// length given by predict (if any) is in.
+static esp_err_t posix_read(void *ctx, uint8_t *buf, size_t buf_len, size_t *out_len, int overall_timeout_ms,
+                            modbus_rtu_frame_len_fn_t predict, void *arg)
+{
+    modbus_rtu_posix_port_t *pp = (modbus_rtu_posix_port_t*)ctx;
+    const int64_t deadline_us = (overall_timeout_ms >= 0) ? mb_time_us() + (int64_t)overall_timeout_ms * 1000 : -1;
+
+    while (1) {
+        int64_t wait_us;
+        if (*out_len > 0) {
+            wait_us = pp->inter_frame_timeout_us;
+        } else if (deadline_us >= 0) {
+            wait_us = deadline_us - mb_time_us();
+            if (wait_us <= 0) return ESP_ERR_MODBUS_RTU_TIMEOUT;
+        } else {
+            wait_us = -1;
+        }
+
+        int r = wait_readable(pp->fd, wait_us);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return ESP_ERR_MODBUS_RTU_PORT;
+        }
+        if (r == 0) {
+            if (*out_len > 0) return ESP_OK;
+            continue; // deadline re-checked above
+        }
+
+        ssize_t n = read(pp->fd, buf + *out_len, buf_len - *out_len);
+        if (n > 0) {
+            *out_len += (size_t)n;
+            if (predict) {
+                size_t want = predict(buf, *out_len, arg);
+                if (want && *out_len == want) return ESP_OK;   // longer: end on the gap
+            }
+            if (*out_len >= buf_len) { rx_drain(pp->fd); return ESP_ERR_NO_MEM; }
+        } else if (n == 0) {
+            return ESP_ERR_MODBUS_RTU_PORT; // peer closed
+        } else if (errno != EAGAIN && errno != EINTR) {
+            return ESP_ERR_MODBUS_RTU_PORT;
+        }
+    }
+}
+
+static esp_err_t posix_read_frame(void *ctx, uint8_t *buf, size_t buf_len,
+                                  size_t *out_len, int overall_timeout_ms)
+{
+    return posix_read(ctx, buf, buf_len, out_len, overall_timeout_ms, NULL, NULL);
+}
+
+static esp_err_t posix_read_frame_expect(void *ctx, uint8_t *buf, size_t buf_len, size_t *out_len,
+                                         int overall_timeout_ms, modbus_rtu_frame_len_fn_t predict, void *arg)
+{
+    return posix_read(ctx, buf, buf_len, out_len, overall_timeout_ms, predict, arg);
+}
+
+const modbus_rtu_transport_t modbus_rtu_transport_posix = {
+    .init = posix_init,
+    .write_adu = posix_write_adu,
+    .read_frame = posix_read_frame,
+    .read_frame_expect = posix_read_frame_expect,
+    .deinit = posix_deinit,
+};
+
+esp_err_t modbus_rtu_posix_socketpair(int fds[2])
+{
+    if (!fds) return ESP_ERR_INVALID_ARG;
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return ESP_ERR_MODBUS_RTU_PORT;
+    // A vanished peer should surface as a port error, not kill the process
+    signal(SIGPIPE, SIG_IGN);
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_posix_openpty(int *master_fd, int *slave_fd, char *slave_name, size_t slave_name_len)
+{
+    if (!master_fd || !slave_fd) return ESP_ERR_INVALID_ARG;
+
+    int m = posix_openpt(O_RDWR | O_NOCTTY);
+    if (m < 0) return ESP_ERR_MODBUS_RTU_PORT;
+
+    char name[64];
+    if (grantpt(m) != 0 || unlockpt(m) != 0 || ptsname_r(m, name, sizeof(name)) != 0) {
+        close(m);
+        return ESP_ERR_MODBUS_RTU_PORT;
+    }
+
+    int s = open(name, O_RDWR | O_NOCTTY);
+    if (s < 0) { close(m); return ESP_ERR_MODBUS_RTU_PORT; }
+
+    // Raw on both ends so no byte is ever translated or echoed
+    if (set_raw_nonblock(m) != ESP_OK || set_raw_nonblock(s) != ESP_OK) {
+        close(s);
+        close(m);
+        return ESP_ERR_MODBUS_RTU_PORT;
+    }
+
+    if (slave_name && slave_name_len) snprintf(slave_name, slave_name_len, "%s", name);
+    *master_fd = m;
+    *slave_fd = s;
+    return ESP_OK;
+}
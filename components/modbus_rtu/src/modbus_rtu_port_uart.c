@@ -15,17 +15,76 @@ static inline void de_re_set(mb_port_t *p, bool tx)
     gpio_set_level(p->de_re_io, level);
 }
 
-esp_err_t mb_port_init(mb_port_t *p, const modbus_rtu_uart_config_t *uart_cfg,
-                       int inter_frame_timeout_us, int txrx_turnaround_us)
+// Hardware RX timeout is counted in character times.
+static uint8_t rx_timeout_symbols(uint32_t char_time_us, uint32_t gap_us)
 {
-    if (!p || !uart_cfg) return ESP_ERR_INVALID_ARG;
+    uint32_t sym = (gap_us + char_time_us - 1) / char_time_us;
+    if (sym < 1) sym = 1;
+    if (sym > 126) sym = 126;
+    return (uint8_t)sym;
+}
+
+// Driver default RX FIFO full threshold
+#define MB_RX_FULL_THRESH 120
+
+static void rx_threshold(mb_port_t *p, size_t bytes)
+{
+    if (bytes > MB_RX_FULL_THRESH) bytes = MB_RX_FULL_THRESH;
+    uart_set_rx_full_threshold(p->uart_num, (int)bytes);
+}
+
+static void rx_flush(mb_port_t *p)
+{
+    uart_flush_input(p->uart_num);
+    if (p->uart_queue) xQueueReset(p->uart_queue);
+}
+
+// enforce_t15: the hardware RX timeout needs data in the FIFO, so it can
+// report t1.5 of silence but not the quiet rest of the gap. gap_timer times
+// that and posts this event (.size = gap_seq) into the driver's event queue;
+// a UART_DATA ahead of it is a character inside the gap.
+#define MB_EV_GAP_END UART_EVENT_MAX
+
+static void gap_timer_cb(void *arg)
+{
+    mb_port_t *p = (mb_port_t*)arg;
+    uart_event_t ev = { .type = MB_EV_GAP_END, .size = p->gap_seq };
+    xQueueSend(p->uart_queue, &ev, 0);
+}
+
+// (Re)starts the silence window, returns its length in ticks (rounded up)
+static TickType_t gap_start(mb_port_t *p, uint32_t window_us)
+{
+    esp_timer_stop(p->gap_timer);
+    p->gap_seq++;           // a late event from an earlier window is ignored
+    rx_threshold(p, 1);     // any character in the window is reported at once
+    esp_timer_start_once(p->gap_timer, window_us);
+    return mb_ticks_ceil(window_us);
+}
+
+static void gap_stop(mb_port_t *p)
+{
+    esp_timer_stop(p->gap_timer);
+    p->gap_seq++;
+    rx_threshold(p, MB_RX_FULL_THRESH);
+}
+
+// Timing fields of the port are filled in by mb_port_init() before this runs.
+static esp_err_t uart_init(void *ctx, const modbus_rtu_transport_params_t *params)
+{
+    mb_port_t *p = (mb_port_t*)ctx;
+    const modbus_rtu_uart_config_t *uart_cfg = params->uart;
+    esp_err_t err;
 
     p->uart_num = uart_cfg->uart_num;
     p->rs485_mode = uart_cfg->use_uart_rs485_mode;
     p->de_re_io = uart_cfg->de_re_io;
     p->de_re_active_high = uart_cfg->de_re_active_high;
-    p->txrx_turnaround_us = (txrx_turnaround_us < 0) ? 0 : txrx_turnaround_us;
-    p->inter_frame_timeout_us = (inter_frame_timeout_us <= 0) ? 2000 : inter_frame_timeout_us;
+    p->rx_mode = uart_cfg->rx_mode;
+    // t1.5 needs the hardware RX timeout to fire mid-frame, so only RX_EVENT can check it
+    p->enforce_t15 = params->enforce_t15 && p->rx_mode == MODBUS_RTU_RX_EVENT &&
+                     (int)p->t15_us < p->inter_frame_timeout_us;
+    p->uart_queue = NULL;
 
     uart_config_t ucfg = {
         .baud_rate = uart_cfg->baudrate ? uart_cfg->baudrate : 115200,
@@ -36,14 +95,12 @@ esp_err_t mb_port_init(mb_port_t *p, const modbus_rtu_uart_config_t *uart_cfg,
         .source_clk = UART_SCLK_DEFAULT,
     };
 
-    esp_err_t err;
-
     err = uart_driver_install(
         p->uart_num,
         uart_cfg->rx_buf_size ? uart_cfg->rx_buf_size : MB_RXBUF_DEFAULT,
         uart_cfg->tx_buf_size ? uart_cfg->tx_buf_size : MB_TXBUF_DEFAULT,
         uart_cfg->uart_event_queue_size ? uart_cfg->uart_event_queue_size : MB_EVTQ_DEFAULT,
-        NULL,
+        (p->rx_mode == MODBUS_RTU_RX_EVENT) ? &p->uart_queue : NULL,
         0
     );
     if (err != ESP_OK) { ESP_LOGE(TAG, "uart_driver_install: %s", esp_err_to_name(err)); return err; }
@@ -72,22 +129,40 @@ esp_err_t mb_port_init(mb_port_t *p, const modbus_rtu_uart_config_t *uart_cfg,
         }
     }
 
-    uart_flush_input(p->uart_num);
+    if (p->rx_mode == MODBUS_RTU_RX_EVENT) {
+        uint32_t gap_us = p->enforce_t15 ? p->t15_us : (uint32_t)p->inter_frame_timeout_us;
+        err = uart_set_rx_timeout(p->uart_num, rx_timeout_symbols(p->char_time_us, gap_us));
+        if (err != ESP_OK) { ESP_LOGE(TAG, "uart_set_rx_timeout: %s", esp_err_to_name(err)); return err; }
+    }
+
+    p->gap_timer = NULL;
+    if (p->enforce_t15) {
+        const esp_timer_create_args_t targs = { .callback = gap_timer_cb, .arg = p, .name = "mb_t15" };
+        err = esp_timer_create(&targs, &p->gap_timer);
+        if (err != ESP_OK) { ESP_LOGE(TAG, "esp_timer_create: %s", esp_err_to_name(err)); return err; }
+    }
+
+    rx_flush(p);
     de_re_set(p, false);
     return ESP_OK;
 }
 
-void mb_port_deinit(mb_port_t *p)
+static void uart_deinit(void *ctx)
 {
-    if (!p) return;
+    mb_port_t *p = (mb_port_t*)ctx;
+    if (p->gap_timer) {
+        esp_timer_stop(p->gap_timer);
+        esp_timer_delete(p->gap_timer);
+        p->gap_timer = NULL;
+    }
     uart_driver_delete(p->uart_num);
 }
 
-esp_err_t mb_port_write_adu(mb_port_t *p, const uint8_t *adu, size_t adu_len)
+static esp_err_t uart_write_adu(void *ctx, const uint8_t *adu, size_t adu_len)
 {
-    if (!p || !adu || adu_len == 0) return ESP_ERR_INVALID_ARG;
+    mb_port_t *p = (mb_port_t*)ctx;
 
-    uart_flush_input(p->uart_num);
+    rx_flush(p);
 
     if (p->txrx_turnaround_us) esp_rom_delay_us((uint32_t)p->txrx_turnaround_us);
 
@@ -104,16 +179,23 @@ esp_err_t mb_port_write_adu(mb_port_t *p, const uint8_t *adu, size_t adu_len)
     return ESP_OK;
 }
 
-// Read a single RTU frame:
+// Bytes still needed for predict() to tell the frame length (header), or to
+// complete the predicted frame. 0 = not predictable, wait for the gap.
+static size_t rx_missing(const uint8_t *buf, size_t len, modbus_rtu_frame_len_fn_t predict, void *arg)
+{
+    size_t n = predict(buf, len, arg);
+    if (n) return n > len ? n - len : 0;
+    return len < 3 ? 3 - len : 0;
+}
+
+// Read a single RTU frame (RX_POLL):
 // - read bytes in small chunks
 // - if idle >= inter_frame_timeout_us after having received data => end-of-frame
+// - with predict, ask for exactly the missing bytes and return with the last one
 // - overall_timeout_ms caps total waiting time
-esp_err_t mb_port_read_frame(mb_port_t *p, uint8_t *buf, size_t buf_len,
-                             size_t *out_len, int overall_timeout_ms)
+static esp_err_t read_frame_poll(mb_port_t *p, uint8_t *buf, size_t buf_len, size_t *out_len, int overall_timeout_ms,
+                                 modbus_rtu_frame_len_fn_t predict, void *arg)
 {
-    if (!p || !buf || !out_len || buf_len < 5) return ESP_ERR_INVALID_ARG;
-    *out_len = 0;
-
     const int64_t start_us = mb_time_us();
     int64_t last_rx_us = 0;
     bool got_any = false;
@@ -127,6 +209,8 @@ esp_err_t mb_port_read_frame(mb_port_t *p, uint8_t *buf, size_t buf_len,
 
         int to_read = (int)(buf_len - *out_len);
         if (to_read <= 0) return ESP_ERR_NO_MEM;
+        size_t missing = predict ? rx_missing(buf, *out_len, predict, arg) : 0;
+        if (missing && missing < (size_t)to_read) to_read = (int)missing;
 
         int r = uart_read_bytes(p->uart_num, buf + *out_len, to_read, pdMS_TO_TICKS(5));
         if (r > 0) {
@@ -134,7 +218,9 @@ esp_err_t mb_port_read_frame(mb_port_t *p, uint8_t *buf, size_t buf_len,
             last_rx_us = mb_time_us();
             got_any = true;
 
+            if (missing && (size_t)r == missing && predict(buf, *out_len, arg) == *out_len) return ESP_OK;
             if (*out_len >= buf_len) return ESP_ERR_NO_MEM;
+            if (missing) continue;  // uart_read_bytes() blocks for the rest
         } else {
             if (got_any) {
                 int64_t idle_us = mb_time_us() - last_rx_us;
@@ -146,3 +232,124 @@ esp_err_t mb_port_read_frame(mb_port_t *p, uint8_t *buf, size_t buf_len,
         vTaskDelay(pdMS_TO_TICKS(1));
     }
 }
+
+// Read a single RTU frame (RX_EVENT):
+// The driver posts UART_DATA when its FIFO threshold is reached and, with
+// timeout_flag set, once the line has been idle for the programmed RX timeout.
+// Without enforce_t15 that timeout is the inter-frame gap and ends the frame.
+// With it, the timeout is t1.5 and gap_timer times the rest of the gap; a
+// character inside it marks the frame bad and restarts the whole gap.
+// With predict, the FIFO threshold is moved to the number of missing bytes,
+// so UART_DATA arrives with the last CRC byte and ends the frame.
+static esp_err_t read_frame_event(mb_port_t *p, uint8_t *buf, size_t buf_len, size_t *out_len, int overall_timeout_ms,
+                                  modbus_rtu_frame_len_fn_t predict, void *arg)
+{
+    const int64_t start_us = mb_time_us();
+    bool bad_frame = false;
+    bool in_gap = false;        // waiting for MB_EV_GAP_END
+    TickType_t gap_ticks = 0;
+    esp_err_t ret;
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        if (overall_timeout_ms >= 0) {
+            int64_t left_ms = overall_timeout_ms - (mb_time_us() - start_us) / 1000;
+            if (left_ms <= 0) { ret = ESP_ERR_MODBUS_RTU_TIMEOUT; goto out; }
+            wait = pdMS_TO_TICKS(left_ms);
+            if (wait == 0) wait = 1;
+        }
+        if (in_gap && wait > gap_ticks + 1) wait = gap_ticks + 1;
+
+        uart_event_t ev;
+        if (xQueueReceive(p->uart_queue, &ev, wait) != pdTRUE) {
+            if (!in_gap) continue;
+            // The queue was full when the timer fired: the window is over anyway
+            ev = (uart_event_t){ .type = MB_EV_GAP_END, .size = p->gap_seq };
+        }
+
+        switch (ev.type) {
+            case MB_EV_GAP_END:
+                if (!in_gap || ev.size != p->gap_seq) break;
+                ret = bad_frame ? ESP_ERR_MODBUS_RTU_FRAME : ESP_OK;
+                goto out;
+            case UART_DATA: {
+                if (in_gap) {
+                    // t1.5 violation (or more of a bad frame): drop it after a whole quiet gap
+                    bad_frame = true;
+                    gap_ticks = gap_start(p, (uint32_t)p->inter_frame_timeout_us);
+                }
+                size_t avail = 0;
+                uart_get_buffered_data_len(p->uart_num, &avail);
+                if (avail > buf_len - *out_len) { rx_flush(p); ret = ESP_ERR_NO_MEM; goto out; }
+                if (avail) {
+                    int r = uart_read_bytes(p->uart_num, buf + *out_len, (uint32_t)avail, 0);
+                    if (r > 0) *out_len += (size_t)r;
+                }
+                if (predict && !bad_frame && *out_len) {
+                    size_t missing = rx_missing(buf, *out_len, predict, arg);
+                    // Only an exact length ends the frame; extra bytes wait for the gap
+                    if (!missing && predict(buf, *out_len, arg) == *out_len) { ret = ESP_OK; goto out; }
+                    rx_threshold(p, missing ? missing : MB_RX_FULL_THRESH);
+                }
+                if (in_gap || !ev.timeout_flag || *out_len == 0) break;
+
+                if (p->enforce_t15) {
+                    gap_ticks = gap_start(p, (uint32_t)p->inter_frame_timeout_us - p->t15_us);
+                    in_gap = true;
+                    break;
+                }
+                ret = bad_frame ? ESP_ERR_MODBUS_RTU_FRAME : ESP_OK;
+                goto out;
+            }
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                rx_flush(p);
+                ret = ESP_ERR_MODBUS_RTU_PORT;
+                goto out;
+            case UART_FRAME_ERR:
+            case UART_PARITY_ERR:
+                bad_frame = true;
+                break;
+            default:
+                break;
+        }
+    }
+
+out:
+    if (in_gap) gap_stop(p);
+    if (ret == ESP_ERR_MODBUS_RTU_FRAME) *out_len = 0;
+    return ret;
+}
+
+static esp_err_t uart_read_frame(void *ctx, uint8_t *buf, size_t buf_len,
+                                 size_t *out_len, int overall_timeout_ms)
+{
+    mb_port_t *p = (mb_port_t*)ctx;
+
+    if (p->rx_mode == MODBUS_RTU_RX_EVENT && p->uart_queue) {
+        return read_frame_event(p, buf, buf_len, out_len, overall_timeout_ms, NULL, NULL);
+    }
+    return read_frame_poll(p, buf, buf_len, out_len, overall_timeout_ms, NULL, NULL);
+}
+
+static esp_err_t uart_read_frame_expect(void *ctx, uint8_t *buf, size_t buf_len, size_t *out_len,
+                                        int overall_timeout_ms, modbus_rtu_frame_len_fn_t predict, void *arg)
+{
+    mb_port_t *p = (mb_port_t*)ctx;
+
+    if (p->rx_mode == MODBUS_RTU_RX_EVENT && p->uart_queue) {
+        rx_threshold(p, 3);     // enough to predict the length
+        esp_err_t err = read_frame_event(p, buf, buf_len, out_len, overall_timeout_ms, predict, arg);
+        rx_threshold(p, MB_RX_FULL_THRESH);
+        return err;
+    }
+    return read_frame_poll(p, buf, buf_len, out_len, overall_timeout_ms, predict, arg);
+}
+
+const modbus_rtu_transport_t mb_uart_transport = {
+    .init = uart_init,
+    .write_adu = uart_write_adu,
+    .read_frame = uart_read_frame,
+    .deinit = uart_deinit,
+    .read_frame_expect = uart_read_frame_expect,
+};
@@ -0,0 +1,279 @@
+#include "modbus_rtu_internal.h"
+
+static const char *TAG = "modbus_rtu_sched";
+
+typedef struct {
+    bool used;
+    modbus_rtu_poll_item_t item;
+    int64_t deadline_us;
+    uint32_t wire_us;
+    uint8_t adu[8];             // request sealed once by modbus_rtu_sched_add()
+    uint16_t rsp_len;
+
+    uint32_t runs;
+    uint32_t errors;
+    uint32_t missed;
+    int64_t jitter_max_us;
+    int64_t jitter_sum_us;
+} mb_poll_slot_t;
+
+struct modbus_rtu_sched_s {
+    modbus_rtu_t *mb;
+    modbus_rtu_sched_config_t cfg;
+
+    SemaphoreHandle_t lock;
+    mb_poll_slot_t *slots;
+
+    TaskHandle_t task;
+    SemaphoreHandle_t done;
+    volatile bool running;
+};
+
+// Request is always 8 bytes; response is 5 + byte count. Each frame is
+// followed by t3.5 and turned around on the half-duplex line.
+static uint32_t mb_poll_wire_us(const modbus_rtu_t *mb, const modbus_rtu_poll_item_t *it)
+{
+    uint32_t byte_count = (it->function <= MB_FC_READ_DISCRETE_INPUTS) ? (it->qty + 7u) / 8u : it->qty * 2u;
+    uint32_t chars = 8u + 5u + byte_count;
+    return chars * mb->port.char_time_us + 2u * mb->port.t35_us + 2u * (uint32_t)mb->port.txrx_turnaround_us;
+}
+
+static uint32_t mb_sched_load_locked(const modbus_rtu_sched_t *s)
+{
+    uint64_t permille = 0;
+    for (int i = 0; i < s->cfg.max_items; ++i) {
+        const mb_poll_slot_t *sl = &s->slots[i];
+        if (!sl->used) continue;
+        permille += (uint64_t)sl->wire_us * 1000u / ((uint64_t)sl->item.period_ms * 1000u);
+    }
+    return (uint32_t)permille;
+}
+
+static int mb_sched_pick_locked(const modbus_rtu_sched_t *s)
+{
+    int best = -1;
+    for (int i = 0; i < s->cfg.max_items; ++i) {
+        const mb_poll_slot_t *sl = &s->slots[i];
+        if (!sl->used) continue;
+        if (best < 0) { best = i; continue; }
+        const mb_poll_slot_t *b = &s->slots[best];
+        if (sl->deadline_us < b->deadline_us ||
+            (sl->deadline_us == b->deadline_us && sl->item.priority > b->item.priority)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void mb_sched_task(void *arg)
+{
+    modbus_rtu_sched_t *s = (modbus_rtu_sched_t*)arg;
+    modbus_rtu_frame_t f;
+
+    while (s->running) {
+        xSemaphoreTake(s->lock, portMAX_DELAY);
+        int id = mb_sched_pick_locked(s);
+        int64_t deadline = (id >= 0) ? s->slots[id].deadline_us : 0;
+        modbus_rtu_poll_item_t item;
+        uint8_t adu[8];
+        uint16_t expect = 0;
+        if (id >= 0) {
+            item = s->slots[id].item;
+            memcpy(adu, s->slots[id].adu, sizeof(adu));
+            expect = s->slots[id].rsp_len;
+        }
+        xSemaphoreGive(s->lock);
+
+        if (id < 0) { ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100)); continue; }
+
+        int64_t left = deadline - mb_time_us();
+        if (left > MB_SPIN_MAX_US) {
+            // Also woken by add/remove/stop: re-evaluate either way
+            ulTaskNotifyTake(pdTRUE, mb_ticks_ceil(left));
+            continue;
+        }
+        if (left > 0) mb_delay_us((uint32_t)left);
+
+        int64_t start = mb_time_us();
+        modbus_rtu_exception_t ex = {0};
+        const uint8_t *rsp = NULL;
+        size_t rsp_len = 0;
+        esp_err_t err = mb_master_run_adu(s->mb, adu, sizeof(adu), expect, &f, &rsp, &rsp_len, &ex);
+        int64_t end = mb_time_us();
+        int64_t period_us = (int64_t)item.period_ms * 1000;
+
+        xSemaphoreTake(s->lock, portMAX_DELAY);
+        mb_poll_slot_t *sl = &s->slots[id];
+        if (sl->used && sl->deadline_us == deadline) {
+            int64_t jitter = start - deadline;
+            sl->runs++;
+            if (err != ESP_OK) sl->errors++;
+            if (jitter > sl->jitter_max_us) sl->jitter_max_us = jitter;
+            sl->jitter_sum_us += jitter;
+            // Stay on the original grid; a poll that ends past its next
+            // deadline missed it, and those periods are skipped, not bunched up
+            sl->deadline_us = deadline + period_us;
+            if (sl->deadline_us <= end) {
+                int64_t behind = (end - sl->deadline_us) / period_us + 1;
+                sl->missed += (uint32_t)behind;
+                sl->deadline_us += behind * period_us;
+            }
+        }
+        xSemaphoreGive(s->lock);
+
+        if (item.callback) item.callback(id, err, &ex, rsp, rsp_len, item.user);
+    }
+
+    xSemaphoreGive(s->done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t modbus_rtu_sched_create(modbus_rtu_t *mb, const modbus_rtu_sched_config_t *cfg, modbus_rtu_sched_t **out)
+{
+    if (!mb || mb->role != MB_ROLE_MASTER) return ESP_ERR_INVALID_STATE;
+    if (!out) return ESP_ERR_INVALID_ARG;
+    *out = NULL;
+
+    modbus_rtu_sched_t *s = (modbus_rtu_sched_t*)calloc(1, sizeof(modbus_rtu_sched_t));
+    if (!s) return ESP_ERR_NO_MEM;
+
+    s->mb = mb;
+    if (cfg) s->cfg = *cfg;
+    if (s->cfg.max_items <= 0) s->cfg.max_items = 32;
+    if (s->cfg.task_stack <= 0) s->cfg.task_stack = 4096;
+    if (s->cfg.task_priority <= 0) s->cfg.task_priority = 5;
+
+    s->slots = (mb_poll_slot_t*)calloc((size_t)s->cfg.max_items, sizeof(mb_poll_slot_t));
+    s->lock = xSemaphoreCreateMutex();
+    s->done = xSemaphoreCreateBinary();
+    if (!s->slots || !s->lock || !s->done) { modbus_rtu_sched_destroy(s); return ESP_ERR_NO_MEM; }
+
+    *out = s;
+    return ESP_OK;
+}
+
+void modbus_rtu_sched_destroy(modbus_rtu_sched_t *s)
+{
+    if (!s) return;
+    modbus_rtu_sched_stop(s);
+    if (s->lock) vSemaphoreDelete(s->lock);
+    if (s->done) vSemaphoreDelete(s->done);
+    free(s->slots);
+    free(s);
+}
+
+esp_err_t modbus_rtu_sched_start(modbus_rtu_sched_t *s)
+{
+    if (!s) return ESP_ERR_INVALID_ARG;
+    if (s->task) return ESP_ERR_INVALID_STATE;
+
+    // First poll of every item is due now
+    int64_t now = mb_time_us();
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    for (int i = 0; i < s->cfg.max_items; ++i) s->slots[i].deadline_us = now;
+    xSemaphoreGive(s->lock);
+
+    s->running = true;
+    BaseType_t ok = xTaskCreatePinnedToCore(mb_sched_task, "mb_sched", (uint32_t)s->cfg.task_stack, s,
+                                            (UBaseType_t)s->cfg.task_priority, &s->task,
+                                            s->cfg.pin_to_core ? s->cfg.task_core : tskNO_AFFINITY);
+    if (ok != pdPASS) { s->running = false; s->task = NULL; return ESP_ERR_NO_MEM; }
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_sched_stop(modbus_rtu_sched_t *s)
+{
+    if (!s) return ESP_ERR_INVALID_ARG;
+    if (!s->task) return ESP_OK;
+
+    s->running = false;
+    xTaskNotifyGive(s->task);
+    xSemaphoreTake(s->done, portMAX_DELAY);
+    s->task = NULL;
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_sched_add(modbus_rtu_sched_t *s, const modbus_rtu_poll_item_t *item, int *out_id)
+{
+    if (!s || !item) return ESP_ERR_INVALID_ARG;
+    if (item->function < MB_FC_READ_COILS || item->function > MB_FC_READ_INPUT_REGS) return ESP_ERR_INVALID_ARG;
+    if (item->unit_id == 0 || item->period_ms == 0) return ESP_ERR_INVALID_ARG;
+    uint16_t max_qty = (item->function <= MB_FC_READ_DISCRETE_INPUTS) ? 2000 : 125;
+    if (item->qty < 1 || item->qty > max_qty) return ESP_ERR_INVALID_ARG;
+
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    int id = -1;
+    for (int i = 0; i < s->cfg.max_items; ++i) {
+        if (!s->slots[i].used) { id = i; break; }
+    }
+    if (id < 0) { xSemaphoreGive(s->lock); return ESP_ERR_NO_MEM; }
+
+    mb_poll_slot_t *sl = &s->slots[id];
+    memset(sl, 0, sizeof(*sl));
+    sl->used = true;
+    sl->item = *item;
+    sl->wire_us = mb_poll_wire_us(s->mb, item);
+    uint8_t *a = sl->adu;
+    a[0] = item->unit_id;
+    a[1] = item->function;
+    a[2] = (uint8_t)(item->addr >> 8);
+    a[3] = (uint8_t)(item->addr & 0xFF);
+    a[4] = (uint8_t)(item->qty >> 8);
+    a[5] = (uint8_t)(item->qty & 0xFF);
+    uint16_t crc = modbus_rtu_crc16(a, 6);
+    a[6] = (uint8_t)(crc & 0xFF);
+    a[7] = (uint8_t)(crc >> 8);
+    sl->rsp_len = (uint16_t)mb_expected_rsp_len(&a[1], 5);
+    sl->deadline_us = mb_time_us();
+
+    uint32_t load = mb_sched_load_locked(s);
+    xSemaphoreGive(s->lock);
+
+    if (load > 1000) {
+        MB_LOGW(TAG, "Poll schedule needs %u.%u%% of bus capacity", (unsigned)(load / 10), (unsigned)(load % 10));
+    }
+
+    if (s->task) xTaskNotifyGive(s->task);
+    if (out_id) *out_id = id;
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_sched_remove(modbus_rtu_sched_t *s, int item_id)
+{
+    if (!s || item_id < 0 || item_id >= s->cfg.max_items) return ESP_ERR_INVALID_ARG;
+
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    bool was_used = s->slots[item_id].used;
+    s->slots[item_id].used = false;
+    xSemaphoreGive(s->lock);
+
+    if (s->task) xTaskNotifyGive(s->task);
+    return was_used ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t modbus_rtu_sched_get_stats(modbus_rtu_sched_t *s, int item_id, modbus_rtu_poll_stats_t *out)
+{
+    if (!s || !out || item_id < 0 || item_id >= s->cfg.max_items) return ESP_ERR_INVALID_ARG;
+
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    const mb_poll_slot_t *sl = &s->slots[item_id];
+    if (!sl->used) { xSemaphoreGive(s->lock); return ESP_ERR_NOT_FOUND; }
+    out->runs = sl->runs;
+    out->errors = sl->errors;
+    out->missed_deadlines = sl->missed;
+    out->wire_time_us = sl->wire_us;
+    out->jitter_max_us = sl->jitter_max_us;
+    out->jitter_avg_us = sl->runs ? sl->jitter_sum_us / sl->runs : 0;
+    xSemaphoreGive(s->lock);
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_sched_get_load(modbus_rtu_sched_t *s, uint32_t *out_permille)
+{
+    if (!s || !out_permille) return ESP_ERR_INVALID_ARG;
+
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    *out_permille = mb_sched_load_locked(s);
+    xSemaphoreGive(s->lock);
+    return ESP_OK;
+}
@@ -0,0 +1,114 @@
+#include "modbus_rtu_internal.h"
+
+#define MB_SPAN_READ_MAX  125
+#define MB_SPAN_WRITE_MAX 123
+
+// One chunk, master_mutex held. The frame is request and response buffer.
+static esp_err_t mb_span_read_chunk(modbus_rtu_t *mb, uint8_t unit_id, uint8_t fc, uint16_t addr, uint16_t qty,
+                                    uint16_t *out, modbus_rtu_frame_t *f, modbus_rtu_exception_t *ex, int *state)
+{
+    uint8_t *req = modbus_rtu_frame_pdu(f);
+    req[0] = fc;
+    req[1] = (uint8_t)(addr >> 8);
+    req[2] = (uint8_t)(addr & 0xFF);
+    req[3] = (uint8_t)(qty >> 8);
+    req[4] = (uint8_t)(qty & 0xFF);
+    mb_frame_seal(f, unit_id, 5);
+
+    const uint8_t *rsp = NULL;
+    size_t rsp_len = 0;
+    esp_err_t err = mb_master_exchange(mb, f->adu, f->adu_len, 5u + qty * 2u, f, &rsp, &rsp_len, ex, state);
+    if (err != ESP_OK) return err;
+    if (!rsp || rsp[0] != fc || rsp[1] != qty * 2) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+
+    for (uint16_t i = 0; i < qty; ++i) out[i] = (uint16_t)((rsp[2 + i * 2] << 8) | rsp[3 + i * 2]);
+    return ESP_OK;
+}
+
+static esp_err_t mb_span_write_chunk(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr, uint16_t qty,
+                                     const uint16_t *src, modbus_rtu_frame_t *f, modbus_rtu_exception_t *ex,
+                                     int *state)
+{
+    uint8_t *req = modbus_rtu_frame_pdu(f);
+    req[0] = MB_FC_WRITE_MULTIPLE_REGS;
+    req[1] = (uint8_t)(addr >> 8);
+    req[2] = (uint8_t)(addr & 0xFF);
+    req[3] = (uint8_t)(qty >> 8);
+    req[4] = (uint8_t)(qty & 0xFF);
+    req[5] = (uint8_t)(qty * 2);
+    for (uint16_t i = 0; i < qty; ++i) {
+        req[6 + i * 2] = (uint8_t)(src[i] >> 8);
+        req[7 + i * 2] = (uint8_t)(src[i] & 0xFF);
+    }
+    mb_frame_seal(f, unit_id, 6u + qty * 2u);
+
+    const uint8_t *rsp = NULL;
+    size_t rsp_len = 0;
+    esp_err_t err = mb_master_exchange(mb, f->adu, f->adu_len, 8, f, &rsp, &rsp_len, ex, state);
+    if (err != ESP_OK || unit_id == 0) return err;
+    if (!rsp || rsp[0] != MB_FC_WRITE_MULTIPLE_REGS) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    if (((rsp[1] << 8) | rsp[2]) != addr || ((rsp[3] << 8) | rsp[4]) != qty) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    return ESP_OK;
+}
+
+// regs is the destination of a read or the source of a write
+static esp_err_t mb_span_run(modbus_rtu_t *mb, uint8_t unit_id, uint8_t fc, uint16_t addr, size_t count,
+                             uint16_t *regs, modbus_rtu_span_chunk_t *chunks, size_t max_chunks, size_t *out_chunks)
+{
+    if (out_chunks) *out_chunks = 0;
+    if (!mb || mb->role != MB_ROLE_MASTER) return ESP_ERR_INVALID_STATE;
+    if (!regs || count < 1 || addr + count > 0x10000u) return ESP_ERR_INVALID_ARG;
+
+    bool write = (fc == MB_FC_WRITE_MULTIPLE_REGS);
+    size_t step = write ? MB_SPAN_WRITE_MAX : MB_SPAN_READ_MAX;
+    size_t n_chunks = (count + step - 1) / step;
+    if (chunks && max_chunks < n_chunks) return ESP_ERR_INVALID_SIZE;
+
+    mb_adapt_pending_t pending = {0};
+    modbus_rtu_frame_t f;
+    esp_err_t first_err = ESP_OK;
+
+    if (xSemaphoreTake(mb->master_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) return ESP_ERR_TIMEOUT;
+    for (size_t i = 0; i < n_chunks; ++i) {
+        size_t off = i * step;
+        uint16_t qty = (uint16_t)((count - off < step) ? count - off : step);
+        uint16_t a = (uint16_t)(addr + off);
+        modbus_rtu_exception_t ex = {0};
+        int state;
+
+        esp_err_t err = write ? mb_span_write_chunk(mb, unit_id, a, qty, regs + off, &f, &ex, &state)
+                              : mb_span_read_chunk(mb, unit_id, fc, a, qty, regs + off, &f, &ex, &state);
+        if (err != ESP_OK && first_err == ESP_OK) first_err = err;
+        mb_adapt_defer(&pending, unit_id, state);
+
+        if (chunks) {
+            chunks[i].addr = a;
+            chunks[i].qty = qty;
+            chunks[i].err = err;
+            chunks[i].ex = ex;
+        }
+    }
+    xSemaphoreGive(mb->master_mutex);
+
+    mb_adapt_flush(mb, &pending);
+    if (out_chunks) *out_chunks = n_chunks;
+    return first_err;
+}
+
+esp_err_t modbus_rtu_read_span(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_table_t table, uint16_t addr,
+                               size_t count, uint16_t *out_regs,
+                               modbus_rtu_span_chunk_t *chunks, size_t max_chunks, size_t *out_chunks)
+{
+    if (table != MODBUS_RTU_TABLE_HOLDING && table != MODBUS_RTU_TABLE_INPUT) return ESP_ERR_INVALID_ARG;
+    if (unit_id == 0) return ESP_ERR_INVALID_ARG;    // reads cannot be broadcast
+    return mb_span_run(mb, unit_id, (uint8_t)table, addr, count, out_regs, chunks, max_chunks, out_chunks);
+}
+
+esp_err_t modbus_rtu_write_span(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr,
+                                size_t count, const uint16_t *regs,
+                                modbus_rtu_span_chunk_t *chunks, size_t max_chunks, size_t *out_chunks)
+{
+    // Only read from on the write path
+    return mb_span_run(mb, unit_id, MB_FC_WRITE_MULTIPLE_REGS, addr, count, (uint16_t*)regs,
+                       chunks, max_chunks, out_chunks);
+}
@@ -0,0 +1,168 @@
+#include "modbus_rtu_internal.h"
+
+#if CONFIG_MODBUS_RTU_STATS
+
+static const uint32_t s_lat_bounds_us[MODBUS_RTU_LAT_BUCKETS - 1] = {
+    500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000,
+};
+
+#define MB_INC(p)      __atomic_fetch_add((p), 1, __ATOMIC_RELAXED)
+#define MB_ADD(p, v)   __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+
+static inline size_t mb_size_bucket(size_t len)
+{
+    size_t b = 0;
+    for (size_t lim = 8; b < MODBUS_RTU_SIZE_BUCKETS - 1 && len > lim; lim <<= 1) b++;
+    return b;
+}
+
+static inline size_t mb_lat_bucket(int64_t us)
+{
+    size_t b = 0;
+    while (b < MODBUS_RTU_LAT_BUCKETS - 1 && us > s_lat_bounds_us[b]) b++;
+    return b;
+}
+
+static modbus_rtu_unit_stats_t *mb_stats_unit(modbus_rtu_t *mb, uint8_t unit_id)
+{
+    if (unit_id == 0 || mb->static_alloc) return NULL;     // static handles stay off the heap
+    modbus_rtu_unit_stats_t **slot = &mb->stats.units[unit_id];
+    modbus_rtu_unit_stats_t *u = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+    if (u) return u;
+
+    // First traffic for this unit; whoever loses the race frees its copy
+    modbus_rtu_unit_stats_t *n = (modbus_rtu_unit_stats_t*)calloc(1, sizeof(*n));
+    if (!n) return NULL;
+    modbus_rtu_unit_stats_t *expected = NULL;
+    if (__atomic_compare_exchange_n(slot, &expected, n, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return n;
+    free(n);
+    return expected;
+}
+
+static void mb_unit_count(modbus_rtu_unit_stats_t *u, esp_err_t err, uint8_t ex_code, int64_t latency_us)
+{
+    switch (err) {
+        case ESP_OK:
+            MB_INC(&u->responses);
+            break;
+        case ESP_ERR_MODBUS_RTU_EXCEPTION:
+            MB_INC(&u->responses);
+            MB_INC(&u->exceptions[ex_code < 12 ? ex_code : 0]);
+            break;
+        case ESP_ERR_MODBUS_RTU_TIMEOUT:
+        case ESP_ERR_TIMEOUT:
+            MB_INC(&u->timeouts);
+            return;
+        case ESP_ERR_MODBUS_RTU_CRC:
+            MB_INC(&u->crc_errors);
+            return;
+        default:
+            MB_INC(&u->bad_responses);
+            return;
+    }
+    if (latency_us >= 0) MB_INC(&u->latency_hist[mb_lat_bucket(latency_us)]);
+}
+
+void mb_stats_init(modbus_rtu_t *mb)
+{
+    mb->stats.since_us = mb_time_us();
+}
+
+void mb_stats_free(modbus_rtu_t *mb)
+{
+    for (int i = 0; i < 256; ++i) free(mb->stats.units[i]);
+}
+
+void mb_stats_request(modbus_rtu_t *mb, uint8_t unit_id)
+{
+    MB_INC(&mb->stats.total.requests);
+    modbus_rtu_unit_stats_t *u = mb_stats_unit(mb, unit_id);
+    if (u) MB_INC(&u->requests);
+}
+
+void mb_stats_frame(modbus_rtu_t *mb, size_t tx_len, size_t rx_len)
+{
+    mb_stats_t *st = &mb->stats;
+    if (tx_len) {
+        MB_ADD(&st->tx_bytes, (uint64_t)tx_len);
+        MB_INC(&st->size_hist[mb_size_bucket(tx_len)]);
+    }
+    if (rx_len) {
+        MB_ADD(&st->rx_bytes, (uint64_t)rx_len);
+        MB_INC(&st->size_hist[mb_size_bucket(rx_len)]);
+    }
+    MB_ADD(&st->busy_us, (uint64_t)(tx_len + rx_len) * mb->port.char_time_us);
+}
+
+void mb_stats_result(modbus_rtu_t *mb, uint8_t unit_id, esp_err_t err, uint8_t ex_code, int64_t latency_us)
+{
+    mb_unit_count(&mb->stats.total, err, ex_code, latency_us);
+    modbus_rtu_unit_stats_t *u = mb_stats_unit(mb, unit_id);
+    if (u) mb_unit_count(u, err, ex_code, latency_us);
+}
+
+// modbus_rtu_unit_stats_t is all uint32_t: copy word by word
+static void mb_unit_snapshot(const modbus_rtu_unit_stats_t *src, modbus_rtu_unit_stats_t *dst)
+{
+    const uint32_t *s = (const uint32_t*)src;
+    uint32_t *d = (uint32_t*)dst;
+    for (size_t i = 0; i < sizeof(*src) / sizeof(uint32_t); ++i) d[i] = __atomic_load_n(&s[i], __ATOMIC_RELAXED);
+}
+
+static void mb_unit_clear(modbus_rtu_unit_stats_t *u)
+{
+    uint32_t *w = (uint32_t*)u;
+    for (size_t i = 0; i < sizeof(*u) / sizeof(uint32_t); ++i) __atomic_store_n(&w[i], 0, __ATOMIC_RELAXED);
+}
+
+esp_err_t modbus_rtu_get_stats(modbus_rtu_t *mb, modbus_rtu_stats_t *out)
+{
+    if (!mb || !out) return ESP_ERR_INVALID_ARG;
+    mb_stats_t *st = &mb->stats;
+
+    mb_unit_snapshot(&st->total, &out->total);
+    for (int i = 0; i < MODBUS_RTU_SIZE_BUCKETS; ++i) out->frame_size_hist[i] = __atomic_load_n(&st->size_hist[i], __ATOMIC_RELAXED);
+    out->tx_bytes = __atomic_load_n(&st->tx_bytes, __ATOMIC_RELAXED);
+    out->rx_bytes = __atomic_load_n(&st->rx_bytes, __ATOMIC_RELAXED);
+    out->busy_us = __atomic_load_n(&st->busy_us, __ATOMIC_RELAXED);
+
+    int64_t elapsed = mb_time_us() - __atomic_load_n(&st->since_us, __ATOMIC_RELAXED);
+    out->elapsed_us = elapsed > 0 ? (uint64_t)elapsed : 0;
+    out->bus_util_permille = out->elapsed_us ? (uint32_t)(out->busy_us * 1000u / out->elapsed_us) : 0;
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_get_unit_stats(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_unit_stats_t *out)
+{
+    if (!mb || !out || unit_id == 0) return ESP_ERR_INVALID_ARG;
+    const modbus_rtu_unit_stats_t *u = __atomic_load_n(&mb->stats.units[unit_id], __ATOMIC_ACQUIRE);
+    if (!u) return ESP_ERR_NOT_FOUND;
+    mb_unit_snapshot(u, out);
+    return ESP_OK;
+}
+
+void modbus_rtu_reset_stats(modbus_rtu_t *mb)
+{
+    if (!mb) return;
+    mb_stats_t *st = &mb->stats;
+
+    // Increments racing with the reset may survive it; counters stay valid
+    mb_unit_clear(&st->total);
+    for (int i = 0; i < MODBUS_RTU_SIZE_BUCKETS; ++i) __atomic_store_n(&st->size_hist[i], 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&st->tx_bytes, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&st->rx_bytes, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&st->busy_us, 0, __ATOMIC_RELAXED);
+    for (int i = 1; i < 256; ++i) {
+        modbus_rtu_unit_stats_t *u = __atomic_load_n(&st->units[i], __ATOMIC_ACQUIRE);
+        if (u) mb_unit_clear(u);
+    }
+    __atomic_store_n(&st->since_us, mb_time_us(), __ATOMIC_RELAXED);
+}
+
+#else
+
+esp_err_t modbus_rtu_get_stats(modbus_rtu_t *mb, modbus_rtu_stats_t *out) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t modbus_rtu_get_unit_stats(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_unit_stats_t *out) { return ESP_ERR_NOT_SUPPORTED; }
+void modbus_rtu_reset_stats(modbus_rtu_t *mb) { (void)mb; }
+
+#endif
@@ -0,0 +1,50 @@
+#include "modbus_rtu_internal.h"
+
+// Modbus over serial line V1.02, 2.5.1.1: for baud rates above 19200 the
+// inter-character and inter-frame gaps are fixed to 750 us and 1750 us.
+#define MB_T15_FIXED_US 750
+#define MB_T35_FIXED_US 1750
+
+esp_err_t modbus_rtu_calc_timing(const modbus_rtu_uart_config_t *uart_cfg, modbus_rtu_timing_t *out)
+{
+    if (!uart_cfg || !out) return ESP_ERR_INVALID_ARG;
+
+    // Same defaults as mb_port_init() applies to the UART itself
+    uint32_t baud = uart_cfg->baudrate > 0 ? (uint32_t)uart_cfg->baudrate : 115200;
+    uart_word_length_t db = uart_cfg->data_bits ? uart_cfg->data_bits : UART_DATA_8_BITS;
+    uart_stop_bits_t sb = uart_cfg->stop_bits ? uart_cfg->stop_bits : UART_STOP_BITS_1;
+
+    // Count in half bits so 1.5 stop bits stays exact
+    uint32_t half_bits = 2;                                    // start
+    half_bits += 2u * (5u + (uint32_t)(db - UART_DATA_5_BITS)); // data
+    if (uart_cfg->parity != UART_PARITY_DISABLE) half_bits += 2;
+    switch (sb) {
+        case UART_STOP_BITS_1_5: half_bits += 3; break;
+        case UART_STOP_BITS_2:   half_bits += 4; break;
+        default:                 half_bits += 2; break;
+    }
+
+    uint64_t char_ns = ((uint64_t)half_bits * 1000000000ULL) / (2ULL * baud);
+
+    out->char_time_us = (uint32_t)((char_ns + 999) / 1000);
+    if (baud > 19200) {
+        out->t15_us = MB_T15_FIXED_US;
+        out->t35_us = MB_T35_FIXED_US;
+    } else {
+        out->t15_us = (uint32_t)((char_ns * 3 / 2 + 999) / 1000);
+        out->t35_us = (uint32_t)((char_ns * 7 / 2 + 999) / 1000);
+    }
+    out->inter_frame_timeout_us = out->t35_us;
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_get_timing(const modbus_rtu_t *mb, modbus_rtu_timing_t *out)
+{
+    if (!mb || !out) return ESP_ERR_INVALID_ARG;
+
+    out->char_time_us = mb->port.char_time_us;
+    out->t15_us = mb->port.t15_us;
+    out->t35_us = mb->port.t35_us;
+    out->inter_frame_timeout_us = (uint32_t)mb->port.inter_frame_timeout_us;
+    return ESP_OK;
+}
@@ -0,0 +1,225 @@
+#include "modbus_rtu_internal.h"
+
+// Values are assembled from the wire bytes in one step per element: a
+// big-endian load (one bswap on little-endian hosts), then the layout's
+// byte swap inside each register and/or register order reversal.
+
+static inline uint32_t mb_load_be32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+static inline uint64_t mb_load_be64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static inline void mb_store_be32(uint8_t *p, uint32_t v)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    memcpy(p, &v, sizeof(v));
+}
+
+static inline void mb_store_be64(uint8_t *p, uint64_t v)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    memcpy(p, &v, sizeof(v));
+}
+
+// Both transforms are their own inverse, so encode uses them unchanged
+static inline uint32_t mb_order32(uint32_t v, modbus_rtu_word_order_t o)
+{
+    if (o & MODBUS_RTU_ORDER_BYTE_SWAP) v = ((v & 0x00FF00FFu) << 8) | ((v >> 8) & 0x00FF00FFu);
+    if (o & MODBUS_RTU_ORDER_WORD_SWAP) v = (v << 16) | (v >> 16);
+    return v;
+}
+
+static inline uint64_t mb_order64(uint64_t v, modbus_rtu_word_order_t o)
+{
+    if (o & MODBUS_RTU_ORDER_BYTE_SWAP) v = ((v & 0x00FF00FF00FF00FFull) << 8) | ((v >> 8) & 0x00FF00FF00FF00FFull);
+    if (o & MODBUS_RTU_ORDER_WORD_SWAP) {
+        v = (v << 32) | (v >> 32);
+        v = ((v & 0x0000FFFF0000FFFFull) << 16) | ((v >> 16) & 0x0000FFFF0000FFFFull);
+    }
+    return v;
+}
+
+size_t modbus_rtu_type_regs(modbus_rtu_value_type_t type)
+{
+    switch (type) {
+        case MODBUS_RTU_TYPE_U16:
+        case MODBUS_RTU_TYPE_I16: return 1;
+        case MODBUS_RTU_TYPE_U32:
+        case MODBUS_RTU_TYPE_I32:
+        case MODBUS_RTU_TYPE_F32: return 2;
+        case MODBUS_RTU_TYPE_U64:
+        case MODBUS_RTU_TYPE_I64:
+        case MODBUS_RTU_TYPE_F64: return 4;
+        default: return 0;
+    }
+}
+
+size_t modbus_rtu_decode(const uint8_t *wire, size_t count, modbus_rtu_layout_t layout, void *out)
+{
+    size_t regs = modbus_rtu_type_regs(layout.type);
+    if (!wire || !out || regs == 0) return 0;
+    modbus_rtu_word_order_t o = layout.order;
+
+    switch (regs) {
+        case 1: {
+            uint16_t *d = (uint16_t*)out;
+            bool swap = o & MODBUS_RTU_ORDER_BYTE_SWAP;
+            for (size_t i = 0; i < count; ++i) {
+                const uint8_t *p = &wire[i * 2];
+                d[i] = swap ? (uint16_t)(p[0] | (p[1] << 8)) : (uint16_t)((p[0] << 8) | p[1]);
+            }
+            break;
+        }
+        case 2: {
+            uint8_t *d = (uint8_t*)out;     // uint32_t or float, bit pattern copied
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t v = mb_order32(mb_load_be32(&wire[i * 4]), o);
+                memcpy(&d[i * 4], &v, 4);
+            }
+            break;
+        }
+        default: {
+            uint8_t *d = (uint8_t*)out;
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t v = mb_order64(mb_load_be64(&wire[i * 8]), o);
+                memcpy(&d[i * 8], &v, 8);
+            }
+            break;
+        }
+    }
+    return count * regs * 2;
+}
+
+size_t modbus_rtu_encode(const void *values, size_t count, modbus_rtu_layout_t layout, uint8_t *wire)
+{
+    size_t regs = modbus_rtu_type_regs(layout.type);
+    if (!values || !wire || regs == 0) return 0;
+    modbus_rtu_word_order_t o = layout.order;
+
+    switch (regs) {
+        case 1: {
+            const uint16_t *s = (const uint16_t*)values;
+            bool swap = o & MODBUS_RTU_ORDER_BYTE_SWAP;
+            for (size_t i = 0; i < count; ++i) {
+                uint16_t v = swap ? (uint16_t)((s[i] << 8) | (s[i] >> 8)) : s[i];
+                wire[i * 2] = (uint8_t)(v >> 8);
+                wire[i * 2 + 1] = (uint8_t)v;
+            }
+            break;
+        }
+        case 2: {
+            const uint8_t *s = (const uint8_t*)values;
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t v;
+                memcpy(&v, &s[i * 4], 4);
+                mb_store_be32(&wire[i * 4], mb_order32(v, o));
+            }
+            break;
+        }
+        default: {
+            const uint8_t *s = (const uint8_t*)values;
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t v;
+                memcpy(&v, &s[i * 8], 8);
+                mb_store_be64(&wire[i * 8], mb_order64(v, o));
+            }
+            break;
+        }
+    }
+    return count * regs * 2;
+}
+
+esp_err_t modbus_rtu_read_typed(modbus_rtu_t *mb, uint8_t unit_id, modbus_rtu_table_t table, uint16_t addr,
+                                size_t count, modbus_rtu_layout_t layout, void *out, modbus_rtu_exception_t *ex)
+{
+    size_t regs = modbus_rtu_type_regs(layout.type);
+    if (!out || regs == 0) return ESP_ERR_INVALID_ARG;
+    if (table != MODBUS_RTU_TABLE_HOLDING && table != MODBUS_RTU_TABLE_INPUT) return ESP_ERR_INVALID_ARG;
+    if (unit_id == 0) return ESP_ERR_INVALID_ARG;    // reads cannot be broadcast
+    if (count < 1 || count * regs > 125) return ESP_ERR_INVALID_ARG;
+    uint16_t qty = (uint16_t)(count * regs);
+
+    if (mb && mb->cache) {
+        // The cache holds host-order registers; put them back in wire order,
+        // in place (register i becomes wire bytes 2i, 2i+1)
+        uint16_t r[125];
+        uint8_t *wire = (uint8_t*)r;
+        esp_err_t err = mb_cache_read_regs(mb, unit_id, (uint8_t)table, addr, qty, r, ex);
+        if (err != ESP_OK) return err;
+        for (uint16_t i = 0; i < qty; ++i) {
+            uint16_t v = r[i];
+            wire[i * 2] = (uint8_t)(v >> 8);
+            wire[i * 2 + 1] = (uint8_t)v;
+        }
+        modbus_rtu_decode(wire, count, layout, out);
+        return ESP_OK;
+    }
+
+    modbus_rtu_frame_t f;
+    uint8_t *req = modbus_rtu_frame_pdu(&f);
+    req[0] = (uint8_t)table;
+    req[1] = (uint8_t)(addr >> 8);
+    req[2] = (uint8_t)(addr & 0xFF);
+    req[3] = (uint8_t)(qty >> 8);
+    req[4] = (uint8_t)(qty & 0xFF);
+
+    const uint8_t *rsp = NULL;
+    size_t rsp_len = 0;
+    esp_err_t err = modbus_rtu_master_transaction_frame(mb, unit_id, &f, 5, &rsp, &rsp_len, ex);
+    if (err != ESP_OK) return err;
+
+    if (!rsp || rsp_len < 2 || rsp[0] != (uint8_t)table) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    if (rsp[1] != qty * 2 || rsp_len != 2u + qty * 2u) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+
+    modbus_rtu_decode(&rsp[2], count, layout, out);
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_write_typed(modbus_rtu_t *mb, uint8_t unit_id, uint16_t addr,
+                                 size_t count, modbus_rtu_layout_t layout, const void *values,
+                                 modbus_rtu_exception_t *ex)
+{
+    size_t regs = modbus_rtu_type_regs(layout.type);
+    if (!values || regs == 0) return ESP_ERR_INVALID_ARG;
+    if (count < 1 || count * regs > 123) return ESP_ERR_INVALID_ARG;
+    uint16_t qty = (uint16_t)(count * regs);
+
+    modbus_rtu_frame_t f;
+    uint8_t *req = modbus_rtu_frame_pdu(&f);
+    req[0] = MB_FC_WRITE_MULTIPLE_REGS;
+    req[1] = (uint8_t)(addr >> 8);
+    req[2] = (uint8_t)(addr & 0xFF);
+    req[3] = (uint8_t)(qty >> 8);
+    req[4] = (uint8_t)(qty & 0xFF);
+    req[5] = (uint8_t)(qty * 2);
+    modbus_rtu_encode(values, count, layout, &req[6]);
+
+    const uint8_t *rsp = NULL;
+    size_t rsp_len = 0;
+    esp_err_t err = modbus_rtu_master_transaction_frame(mb, unit_id, &f, 6u + qty * 2u, &rsp, &rsp_len, ex);
+    if (err != ESP_OK || unit_id == 0) return err;
+
+    // Echo of address and quantity (the response has overwritten req)
+    if (!rsp || rsp_len != 5 || rsp[0] != MB_FC_WRITE_MULTIPLE_REGS) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    if (((rsp[1] << 8) | rsp[2]) != addr || ((rsp[3] << 8) | rsp[4]) != qty) return ESP_ERR_MODBUS_RTU_BAD_RESPONSE;
+    return ESP_OK;
+}
@@ -0,0 +1,365 @@
+// HOST_ONLY: build with `idf.py --preview set-target linux`.
+//
+// End-to-end master <-> slave benchmark over a paced pseudo-terminal.
+// Sweeps baud rate, function code, register count and turnaround, and prints
+// one JSON object per line so runs can be diffed / tracked between releases:
+//
+//   ./build/benchmark.elf > bench.jsonl
+//
+// Environment:
+//   MB_BENCH_SECONDS  target duration per point (default 1)
+//   MB_BENCH_PACE     0 = no wire-time pacing, measures pure stack overhead
+//   MB_BENCH_BUSES    segments in the multi-bus sweep (default 3, 0 = skip)
+//
+// The multi-bus sweep drives 1..N segments through modbus_rtu_bus_mgr, one
+// slave process per segment, and reports aggregate transactions per second
+// and the scaling against one segment. The simulator runs one task at a
+// time, but the POSIX transport waits in vTaskDelay() rather than in the
+// kernel, so the bus tasks overlap their wire time as they do on a target.
+//
+// The slave is a second copy of this program (MB_ROLE=slave) because the
+// FreeRTOS POSIX simulator only runs one task at a time.
+
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "modbus_rtu.h"
+#include "modbus_rtu_port_posix.h"
+
+static const char *TAG = "benchmark";
+
+#define REG_SPACE 256
+static uint16_t regs[REG_SPACE];
+
+static const int bauds[] = { 9600, 19200, 38400, 115200 };
+static const int turnarounds_us[] = { 0, 200 };
+static const uint16_t qtys[] = { 1, 10, 60, 125 };
+static const uint8_t fcs[] = { 0x03, 0x04, 0x10 };
+
+#define MAX_SAMPLES 20000
+
+// ---------------- slave side ----------------
+
+static esp_err_t read_regs(uint16_t addr, uint16_t qty, uint16_t *dest, void *user)
+{
+    (void)user;
+    if ((uint32_t)addr + qty > REG_SPACE) return ESP_ERR_INVALID_SIZE;
+    memcpy(dest, &regs[addr], qty * sizeof(uint16_t));
+    return ESP_OK;
+}
+
+static esp_err_t write_regs(uint16_t addr, uint16_t qty, const uint16_t *src, void *user)
+{
+    (void)user;
+    if ((uint32_t)addr + qty > REG_SPACE) return ESP_ERR_INVALID_SIZE;
+    memcpy(&regs[addr], src, qty * sizeof(uint16_t));
+    return ESP_OK;
+}
+
+static bool env_pace(void)
+{
+    const char *v = getenv("MB_BENCH_PACE");
+    return !(v && v[0] == '0');
+}
+
+static void run_slave(const char *dev, int baud, int turnaround_us, uint8_t unit_id)
+{
+    static modbus_rtu_posix_port_t pp;
+    pp.fd = open(dev, O_RDWR | O_NOCTTY);
+    pp.pace = env_pace();
+    if (pp.fd < 0) exit(1);
+
+    modbus_rtu_uart_config_t ucfg = {
+        .baudrate = baud,
+        .transport = &modbus_rtu_transport_posix,
+        .transport_ctx = &pp,
+    };
+    modbus_rtu_slave_config_t scfg = { .unit_id = unit_id, .txrx_turnaround_us = turnaround_us };
+    modbus_rtu_slave_cb_t cb = {
+        .read_holding = read_regs,
+        .read_input = read_regs,
+        .write_holding = write_regs,
+    };
+
+    modbus_rtu_t *mb = NULL;
+    if (modbus_rtu_slave_create(&ucfg, &scfg, &cb, NULL, &mb) != ESP_OK) exit(1);
+    if (modbus_rtu_slave_start(mb) != ESP_OK) exit(1);
+    while (1) vTaskDelay(pdMS_TO_TICKS(1000));
+}
+
+// ---------------- master side ----------------
+
+typedef struct {
+    int baud;
+    int turnaround_us;
+    uint8_t fc;
+    uint16_t qty;
+} bench_point_t;
+
+static int64_t mono_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t cpu_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int cmp_i64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t*)a, y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static size_t request_len(const bench_point_t *pt)
+{
+    return (pt->fc == 0x10) ? 9u + 2u * pt->qty : 8u;
+}
+
+static size_t response_len(const bench_point_t *pt)
+{
+    return (pt->fc == 0x10) ? 8u : 5u + 2u * pt->qty;
+}
+
+static esp_err_t do_transaction(modbus_rtu_t *mb, const bench_point_t *pt, uint16_t *buf)
+{
+    modbus_rtu_exception_t ex;
+    switch (pt->fc) {
+        case 0x03: return modbus_rtu_read_holding_registers(mb, 1, 0, pt->qty, buf, REG_SPACE, &ex);
+        case 0x04: return modbus_rtu_read_input_registers(mb, 1, 0, pt->qty, buf, REG_SPACE, &ex);
+        default:   return modbus_rtu_write_multiple_registers(mb, 1, 0, pt->qty, buf, REG_SPACE, &ex);
+    }
+}
+
+static pid_t spawn_slave(const char *dev, const bench_point_t *pt, uint8_t unit_id)
+{
+    char e_role[] = "MB_ROLE=slave";
+    char e_dev[96], e_baud[32], e_ta[32], e_pace[32], e_unit[32];
+    snprintf(e_dev, sizeof(e_dev), "MB_DEVICE=%s", dev);
+    snprintf(e_baud, sizeof(e_baud), "MB_BAUD=%d", pt->baud);
+    snprintf(e_ta, sizeof(e_ta), "MB_TURNAROUND=%d", pt->turnaround_us);
+    snprintf(e_pace, sizeof(e_pace), "MB_BENCH_PACE=%d", env_pace() ? 1 : 0);
+    snprintf(e_unit, sizeof(e_unit), "MB_UNIT=%u", unit_id);
+    char *envp[] = { e_role, e_dev, e_baud, e_ta, e_pace, e_unit, NULL };
+    char *argv[] = { "benchmark-slave", NULL };
+
+    pid_t pid = -1;
+    if (posix_spawn(&pid, "/proc/self/exe", NULL, NULL, argv, envp) != 0) return -1;
+    return pid;
+}
+
+static void run_point(const bench_point_t *pt, double seconds, int64_t *lat)
+{
+    static modbus_rtu_posix_port_t pp;
+    int slave_fd = -1;
+    char dev[64];
+    memset(&pp, 0, sizeof(pp));
+    pp.pace = env_pace();
+    if (modbus_rtu_posix_openpty(&pp.fd, &slave_fd, dev, sizeof(dev)) != ESP_OK) {
+        ESP_LOGE(TAG, "openpty failed");
+        return;
+    }
+    pid_t pid = spawn_slave(dev, pt, 1);
+
+    modbus_rtu_uart_config_t ucfg = {
+        .baudrate = pt->baud,
+        .transport = &modbus_rtu_transport_posix,
+        .transport_ctx = &pp,
+    };
+    modbus_rtu_master_config_t mcfg = {
+        .response_timeout_ms = 500,
+        .txrx_turnaround_us = pt->turnaround_us,
+        .strict_unit_id = true,
+        .strict_function = true,
+    };
+    modbus_rtu_t *mb = NULL;
+    if (pid < 0 || modbus_rtu_master_create(&ucfg, &mcfg, &mb) != ESP_OK) {
+        ESP_LOGE(TAG, "setup failed");
+        goto out;
+    }
+
+    uint16_t buf[REG_SPACE] = {0};
+
+    // Wait for the slave process to answer before measuring
+    int64_t ready_by = mono_us() + 3000000;
+    while (do_transaction(mb, pt, buf) != ESP_OK && mono_us() < ready_by) { }
+
+    modbus_rtu_timing_t tm;
+    modbus_rtu_get_timing(mb, &tm);
+    double wire_us = (double)(request_len(pt) + response_len(pt)) * tm.char_time_us;
+
+    int ok = 0, failed = 0, n = 0;
+    int64_t t_start = mono_us();
+    int64_t c_start = cpu_us();
+    int64_t t_end = t_start + (int64_t)(seconds * 1e6);
+    while (n < MAX_SAMPLES && mono_us() < t_end) {
+        int64_t t0 = mono_us();
+        esp_err_t err = do_transaction(mb, pt, buf);
+        lat[n++] = mono_us() - t0;
+        if (err == ESP_OK) ok++;
+        else failed++;
+    }
+    int64_t elapsed = mono_us() - t_start;
+    int64_t cpu = cpu_us() - c_start;
+
+    qsort(lat, (size_t)n, sizeof(int64_t), cmp_i64);
+    double tps = n ? (double)n * 1e6 / (double)elapsed : 0.0;
+
+    printf("{\"type\":\"point\",\"baud\":%d,\"turnaround_us\":%d,\"fc\":%u,\"qty\":%u,"
+           "\"transactions\":%d,\"ok\":%d,\"errors\":%d,\"tps\":%.2f,"
+           "\"lat_p50_us\":%lld,\"lat_p99_us\":%lld,\"lat_max_us\":%lld,"
+           "\"wire_us\":%.1f,\"bus_util\":%.4f,\"cpu_us_per_tx\":%.2f,\"t35_us\":%u}\n",
+           pt->baud, pt->turnaround_us, pt->fc, pt->qty,
+           n, ok, failed, tps,
+           n ? (long long)lat[n / 2] : 0LL,
+           n ? (long long)lat[(n * 99) / 100] : 0LL,
+           n ? (long long)lat[n - 1] : 0LL,
+           wire_us, tps * wire_us / 1e6,
+           n ? (double)cpu / n : 0.0, tm.t35_us);
+    fflush(stdout);
+
+out:
+    if (mb) modbus_rtu_destroy(mb);
+    if (pid > 0) { kill(pid, SIGTERM); waitpid(pid, NULL, 0); }
+    close(slave_fd);
+    close(pp.fd);
+}
+
+// ---------------- multi-bus ----------------
+
+#define MAX_BUSES     4
+#define BUS_INFLIGHT  2     // queued per segment so its task never idles
+
+static double run_multibus(const bench_point_t *pt, int n, double seconds)
+{
+    static modbus_rtu_posix_port_t pp[MAX_BUSES];
+    int slave_fd[MAX_BUSES];
+    pid_t pid[MAX_BUSES];
+    double tps = 0.0;
+
+    modbus_rtu_bus_mgr_t *mgr = NULL;
+    modbus_rtu_bus_mgr_config_t gcfg = { .max_buses = n, .result_queue_len = n * BUS_INFLIGHT };
+    if (modbus_rtu_bus_mgr_create(&gcfg, &mgr) != ESP_OK) return 0.0;
+
+    int opened = 0;
+    for (; opened < n; ++opened) {
+        char dev[64];
+        memset(&pp[opened], 0, sizeof(pp[opened]));
+        pp[opened].pace = env_pace();
+        if (modbus_rtu_posix_openpty(&pp[opened].fd, &slave_fd[opened], dev, sizeof(dev)) != ESP_OK) goto out;
+        pid[opened] = spawn_slave(dev, pt, (uint8_t)(opened + 1));
+
+        modbus_rtu_uart_config_t ucfg = {
+            .baudrate = pt->baud,
+            .transport = &modbus_rtu_transport_posix,
+            .transport_ctx = &pp[opened],
+        };
+        modbus_rtu_master_config_t mcfg = { .response_timeout_ms = 500 };
+        modbus_rtu_t *mb = NULL;
+        if (pid[opened] < 0 || modbus_rtu_master_create(&ucfg, &mcfg, &mb) != ESP_OK) { opened++; goto out; }
+        if (modbus_rtu_bus_mgr_add_bus(mgr, mb, NULL, NULL) != ESP_OK) { modbus_rtu_destroy(mb); opened++; goto out; }
+        modbus_rtu_bus_mgr_map_unit(mgr, (uint8_t)(opened + 1), opened);
+    }
+
+    // Wait for every slave process to answer before measuring
+    for (int b = 0; b < n; ++b) {
+        uint16_t r[1];
+        modbus_rtu_exception_t ex;
+        int64_t ready_by = mono_us() + 3000000;
+        while (modbus_rtu_read_holding_registers(modbus_rtu_bus_mgr_handle(mgr, (uint8_t)(b + 1)), (uint8_t)(b + 1),
+                                                 0, 1, r, 1, &ex) != ESP_OK && mono_us() < ready_by) { }
+    }
+
+    uint8_t pdu[5] = { pt->fc, 0, 0, (uint8_t)(pt->qty >> 8), (uint8_t)pt->qty };
+    int done = 0, inflight = 0, next = 0;
+    int64_t t_start = mono_us();
+    int64_t t_end = t_start + (int64_t)(seconds * 1e6);
+    while (mono_us() < t_end || inflight > 0) {
+        while (mono_us() < t_end && inflight < n * BUS_INFLIGHT) {
+            modbus_rtu_async_req_t req = {
+                .unit_id = (uint8_t)(next % n + 1),
+                .request_pdu = pdu,
+                .request_pdu_len = sizeof(pdu),
+            };
+            if (modbus_rtu_bus_mgr_submit(mgr, &req, 0) != ESP_OK) break;
+            next++;
+            inflight++;
+        }
+        modbus_rtu_bus_result_t res;
+        if (modbus_rtu_bus_mgr_get_result(mgr, &res, pdMS_TO_TICKS(1000)) != ESP_OK) break;
+        inflight--;
+        if (res.err == ESP_OK) done++;
+    }
+    int64_t elapsed = mono_us() - t_start;
+    tps = elapsed > 0 ? (double)done * 1e6 / (double)elapsed : 0.0;
+
+out:
+    modbus_rtu_bus_mgr_destroy(mgr);
+    for (int b = 0; b < opened; ++b) {
+        if (pid[b] > 0) { kill(pid[b], SIGTERM); waitpid(pid[b], NULL, 0); }
+        close(slave_fd[b]);
+        close(pp[b].fd);
+    }
+    return tps;
+}
+
+void app_main(void)
+{
+    const char *role = getenv("MB_ROLE");
+    if (role && strcmp(role, "slave") == 0) {
+        const char *dev = getenv("MB_DEVICE");
+        const char *baud = getenv("MB_BAUD");
+        const char *ta = getenv("MB_TURNAROUND");
+        const char *unit = getenv("MB_UNIT");
+        run_slave(dev ? dev : "", baud ? atoi(baud) : 115200, ta ? atoi(ta) : 0, (uint8_t)(unit ? atoi(unit) : 1));
+    }
+
+    const char *sec = getenv("MB_BENCH_SECONDS");
+    double seconds = sec ? atof(sec) : 1.0;
+    if (seconds <= 0) seconds = 1.0;
+
+    static int64_t lat[MAX_SAMPLES];
+
+    printf("{\"type\":\"meta\",\"bench\":\"modbus_rtu\",\"version\":1,\"pace\":%s,\"seconds_per_point\":%.2f}\n",
+           env_pace() ? "true" : "false", seconds);
+
+    for (size_t b = 0; b < sizeof(bauds) / sizeof(bauds[0]); ++b)
+    for (size_t t = 0; t < sizeof(turnarounds_us) / sizeof(turnarounds_us[0]); ++t)
+    for (size_t f = 0; f < sizeof(fcs) / sizeof(fcs[0]); ++f)
+    for (size_t q = 0; q < sizeof(qtys) / sizeof(qtys[0]); ++q) {
+        bench_point_t pt = { .baud = bauds[b], .turnaround_us = turnarounds_us[t], .fc = fcs[f], .qty = qtys[q] };
+        if (pt.fc == 0x10 && pt.qty > 123) pt.qty = 123; // FC16 limit
+        run_point(&pt, seconds, lat);
+    }
+
+    const char *nb = getenv("MB_BENCH_BUSES");
+    int max_buses = nb ? atoi(nb) : 3;
+    if (max_buses > MAX_BUSES) max_buses = MAX_BUSES;
+    double tps_one = 0.0;
+    for (int n = 1; n <= max_buses; ++n) {
+        bench_point_t pt = { .baud = 19200, .turnaround_us = 0, .fc = 0x03, .qty = 60 };
+        double tps = run_multibus(&pt, n, seconds);
+        if (n == 1) tps_one = tps;
+        printf("{\"type\":\"multibus\",\"buses\":%d,\"baud\":%d,\"fc\":%u,\"qty\":%u,"
+               "\"tps\":%.2f,\"tps_per_bus\":%.2f,\"scaling\":%.2f}\n",
+               n, pt.baud, pt.fc, pt.qty, tps, tps / n, tps_one > 0 ? tps / tps_one : 0.0);
+        fflush(stdout);
+    }
+
+    exit(0);
+}
@@ -0,0 +1,75 @@
+#include <stdio.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "modbus_rtu.h"
+
+static const char *TAG = "crc_bench";
+
+typedef uint16_t (*crc_fn_t)(uint16_t crc, const uint8_t *data, size_t len);
+
+typedef struct {
+    const char *name;
+    crc_fn_t fn;
+} crc_impl_t;
+
+// The "bitwise" engine is the original bit-serial modbus_rtu_crc16 loop.
+static const crc_impl_t impls[] = {
+    { "bitwise", modbus_rtu_crc16_update_bitwise },
+    { "nibble",  modbus_rtu_crc16_update_nibble  },
+    { "table",   modbus_rtu_crc16_update_table   },
+    { "slice8",  modbus_rtu_crc16_update_slice8  },
+};
+
+static const size_t frame_sizes[] = { 8, 16, 64, 128, 256 };
+
+#define ITERATIONS 2000
+
+static uint8_t frame[256];
+
+static uint32_t bench_cycles(crc_fn_t fn, size_t len, uint16_t *out_crc)
+{
+    uint16_t crc = 0;
+    uint32_t t0 = esp_cpu_get_cycle_count();
+    for (int i = 0; i < ITERATIONS; ++i) crc ^= fn(0xFFFF, frame, len);
+    uint32_t t1 = esp_cpu_get_cycle_count();
+    *out_crc = crc;
+    return t1 - t0;
+}
+
+void app_main(void)
+{
+    esp_fill_random(frame, sizeof(frame));
+
+    // Cross-check every engine against the reference before timing anything.
+    for (size_t len = 0; len <= sizeof(frame); ++len) {
+        uint16_t ref = modbus_rtu_crc16_update_bitwise(0xFFFF, frame, len);
+        for (size_t k = 1; k < sizeof(impls) / sizeof(impls[0]); ++k) {
+            if (impls[k].fn(0xFFFF, frame, len) != ref) {
+                ESP_LOGE(TAG, "%s mismatch at len=%u", impls[k].name, (unsigned)len);
+                return;
+            }
+        }
+    }
+
+    printf("%-8s", "bytes");
+    for (size_t k = 0; k < sizeof(impls) / sizeof(impls[0]); ++k) printf(" %10s", impls[k].name);
+    printf("   (CPU cycles per byte)\n");
+
+    for (size_t s = 0; s < sizeof(frame_sizes) / sizeof(frame_sizes[0]); ++s) {
+        size_t len = frame_sizes[s];
+        printf("%-8u", (unsigned)len);
+        for (size_t k = 0; k < sizeof(impls) / sizeof(impls[0]); ++k) {
+            uint16_t sink;
+            uint32_t cycles = bench_cycles(impls[k].fn, len, &sink);
+            printf(" %10.2f", (double)cycles / ((double)ITERATIONS * (double)len));
+            vTaskDelay(1); // keep the idle task / watchdog fed
+        }
+        printf("\n");
+    }
+
+    ESP_LOGI(TAG, "done");
+}
@@ -0,0 +1,109 @@
+// HOST_ONLY: build with `idf.py --preview set-target linux`.
+//
+// Runs a master and a slave over a pseudo-terminal on the development host.
+// The FreeRTOS POSIX simulator only runs one task at a time, so the slave is
+// a second copy of this program (MB_ROLE=slave) rather than a second task.
+
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "modbus_rtu.h"
+#include "modbus_rtu_port_posix.h"
+
+static const char *TAG = "host_loopback";
+static uint16_t holding[16];
+
+static esp_err_t read_holding(uint16_t addr, uint16_t qty, uint16_t *dest, void *user)
+{
+    (void)user;
+    if ((addr + qty) > 16) return ESP_ERR_INVALID_SIZE;
+    for (uint16_t i = 0; i < qty; ++i) dest[i] = holding[addr + i];
+    return ESP_OK;
+}
+
+static modbus_rtu_uart_config_t line_cfg(modbus_rtu_posix_port_t *pp)
+{
+    modbus_rtu_uart_config_t ucfg = {
+        .baudrate = 115200,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .data_bits = UART_DATA_8_BITS,
+        .transport = &modbus_rtu_transport_posix,
+        .transport_ctx = pp,
+    };
+    return ucfg;
+}
+
+static void run_slave(const char *dev)
+{
+    static modbus_rtu_posix_port_t pp = { .pace = true };
+    pp.fd = open(dev, O_RDWR | O_NOCTTY);
+    if (pp.fd < 0) { ESP_LOGE(TAG, "open %s failed", dev); exit(1); }
+
+    for (int i = 0; i < 16; ++i) holding[i] = (uint16_t)(100 + i);
+
+    modbus_rtu_uart_config_t ucfg = line_cfg(&pp);
+    modbus_rtu_slave_config_t scfg = { .unit_id = 1 };
+    modbus_rtu_slave_cb_t cb = { .read_holding = read_holding };
+
+    modbus_rtu_t *mb = NULL;
+    ESP_ERROR_CHECK(modbus_rtu_slave_create(&ucfg, &scfg, &cb, NULL, &mb));
+    ESP_ERROR_CHECK(modbus_rtu_slave_start(mb));
+    while (1) vTaskDelay(pdMS_TO_TICKS(1000));
+}
+
+static void run_master(void)
+{
+    static modbus_rtu_posix_port_t pp = { .pace = true };
+    int slave_fd = -1; // kept open so the pty survives until the slave opens it
+    char slave_name[64];
+    ESP_ERROR_CHECK(modbus_rtu_posix_openpty(&pp.fd, &slave_fd, slave_name, sizeof(slave_name)));
+
+    char *argv[] = { "host_loopback", NULL };
+    char role[] = "MB_ROLE=slave";
+    char dev[96];
+    snprintf(dev, sizeof(dev), "MB_DEVICE=%s", slave_name);
+    char *envp[] = { role, dev, NULL };
+    pid_t pid;
+    if (posix_spawn(&pid, "/proc/self/exe", NULL, NULL, argv, envp) != 0) {
+        ESP_LOGE(TAG, "could not start slave process");
+        exit(1);
+    }
+
+    modbus_rtu_uart_config_t ucfg = line_cfg(&pp);
+    modbus_rtu_master_config_t mcfg = {
+        .response_timeout_ms = 200,
+        .strict_unit_id = true,
+        .strict_function = true,
+    };
+    modbus_rtu_t *mb = NULL;
+    ESP_ERROR_CHECK(modbus_rtu_master_create(&ucfg, &mcfg, &mb));
+
+    vTaskDelay(pdMS_TO_TICKS(200)); // let the slave come up
+
+    for (int n = 0; n < 5; ++n) {
+        uint16_t regs[4] = {0};
+        modbus_rtu_exception_t ex = {0};
+        esp_err_t err = modbus_rtu_read_holding_registers(mb, 1, 0x0000, 4, regs, 4, &ex);
+        if (err == ESP_OK) ESP_LOGI(TAG, "HR[0..3]=%u %u %u %u", regs[0], regs[1], regs[2], regs[3]);
+        else ESP_LOGW(TAG, "read failed: %s", esp_err_to_name(err));
+    }
+
+    kill(pid, SIGTERM);
+    exit(0);
+}
+
+void app_main(void)
+{
+    const char *role = getenv("MB_ROLE");
+    const char *dev = getenv("MB_DEVICE");
+    if (role && dev && role[0] == 's') run_slave(dev);
+    else run_master();
+}
@@ -25,7 +25,7 @@ void app_main(void)
 
     modbus_rtu_master_config_t mcfg = {
         .response_timeout_ms = 200,
-        .inter_frame_timeout_us = 2000,
+        .inter_frame_timeout_us = 0,   // auto: t3.5 from the UART settings
         .txrx_turnaround_us = 200,
         .strict_unit_id = true,
         .strict_function = true,
@@ -5,27 +5,21 @@
 
 static const char *TAG = "example_slave";
 static uint16_t holding[16];
+static modbus_rtu_reg_bank_t bank;
 
-static esp_err_t read_holding(uint16_t addr, uint16_t qty, uint16_t *dest, void *user)
-{
-    (void)user;
-    if ((addr + qty) > 16) return ESP_ERR_INVALID_SIZE;
-    for (uint16_t i = 0; i < qty; ++i) dest[i] = holding[addr + i];
-    return ESP_OK;
-}
-
-static esp_err_t write_holding(uint16_t addr, uint16_t qty, const uint16_t *src, void *user)
-{
-    (void)user;
-    if ((addr + qty) > 16) return ESP_ERR_INVALID_SIZE;
-    for (uint16_t i = 0; i < qty; ++i) holding[addr + i] = src[i];
-    return ESP_OK;
-}
+// Served straight from the bank: no callbacks, no locking in the slave task
+static const modbus_rtu_region_t holding_regions[] = {
+    { .start = 0, .count = 16, .bank = &bank },
+};
+static const modbus_rtu_data_model_t model = {
+    .holding = { holding_regions, 1 },
+};
 
 void app_main(void)
 {
     holding[0] = 123;
     holding[1] = 456;
+    ESP_ERROR_CHECK(modbus_rtu_reg_bank_init(&bank, holding, 16));
 
     modbus_rtu_t *mb = NULL;
 
@@ -45,21 +39,25 @@ void app_main(void)
 
     modbus_rtu_slave_config_t scfg = {
         .unit_id = 1,
-        .inter_frame_timeout_us = 2000,
+        .inter_frame_timeout_us = 0,   // auto: t3.5 from the UART settings
         .rx_poll_delay_ms = 1,
         .txrx_turnaround_us = 200,
         .max_adu_size = 256,
+        .data_model = &model,
     };
 
-    modbus_rtu_slave_cb_t cb = {
-        .read_holding = read_holding,
-        .write_holding = write_holding,
-    };
-
-    ESP_ERROR_CHECK(modbus_rtu_slave_create(&ucfg, &scfg, &cb, NULL, &mb));
+    ESP_ERROR_CHECK(modbus_rtu_slave_create(&ucfg, &scfg, NULL, NULL, &mb));
     ESP_ERROR_CHECK(modbus_rtu_slave_start(mb));
 
     ESP_LOGI(TAG, "Slave running. Try reading holding regs from a master.");
 
-    while (1) vTaskDelay(pdMS_TO_TICKS(1000));
+    // Uptime in seconds as a 32-bit value in registers 2..3; a master reading
+    // both never sees half of an update.
+    uint32_t uptime = 0;
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        uptime++;
+        uint16_t words[2] = { (uint16_t)(uptime >> 16), (uint16_t)(uptime & 0xFFFF) };
+        modbus_rtu_reg_bank_write(&bank, 2, words, 2);
+    }
 }
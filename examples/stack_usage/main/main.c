@@ -0,0 +1,366 @@
+// Heap-free master and slave, plus a stack high-water-mark check.
+//
+// Both handles are created from static storage and talk over an in-memory
+// pipe (two static queues), so no UART wiring is needed. Each master API is
+// then called once from a fresh probe task, and the stack it used (minus the
+// probe's own frames) is checked against MODBUS_RTU_STACK_MASTER_CALL; the
+// slave task is checked against MODBUS_RTU_STACK_SLAVE_TASK. The APIs run
+// three times: plain, with adaptive timeouts, and the register reads again
+// with the read cache on as well (cold, so each takes the fetch path). The
+// last two passes allocate their feature state from the heap. Run with
+// CONFIG_MODBUS_RTU_LOG_LEVEL=0 (sdkconfig.defaults), as the bounds exclude
+// logging.
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "modbus_rtu.h"
+
+static const char *TAG = "stack_usage";
+
+// ---------------- in-memory line ----------------
+
+typedef struct {
+    uint16_t len;
+    uint8_t adu[MODBUS_RTU_ADU_MAX];
+} pipe_frame_t;
+
+typedef struct {
+    QueueHandle_t rx;
+    QueueHandle_t tx;   // the other end's rx
+    pipe_frame_t wbuf;  // staging, keeps frames off the caller's stack
+    pipe_frame_t rbuf;
+} pipe_end_t;
+
+static esp_err_t pipe_init(void *ctx, const modbus_rtu_transport_params_t *params)
+{
+    (void)ctx;
+    (void)params;
+    return ESP_OK;
+}
+
+static esp_err_t pipe_write_adu(void *ctx, const uint8_t *adu, size_t adu_len)
+{
+    pipe_end_t *p = (pipe_end_t*)ctx;
+    pipe_frame_t *f = &p->wbuf;
+    if (adu_len > sizeof(f->adu)) return ESP_ERR_INVALID_SIZE;
+    xQueueReset(p->rx);
+    f->len = (uint16_t)adu_len;
+    memcpy(f->adu, adu, adu_len);
+    return xQueueSend(p->tx, f, portMAX_DELAY) == pdTRUE ? ESP_OK : ESP_ERR_MODBUS_RTU_PORT;
+}
+
+static esp_err_t pipe_read_frame(void *ctx, uint8_t *buf, size_t buf_len, size_t *out_len, int overall_timeout_ms)
+{
+    pipe_end_t *p = (pipe_end_t*)ctx;
+    pipe_frame_t *f = &p->rbuf;
+    TickType_t wait = overall_timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(overall_timeout_ms);
+    *out_len = 0;
+    if (xQueueReceive(p->rx, f, wait) != pdTRUE) return ESP_ERR_MODBUS_RTU_TIMEOUT;
+    if (f->len > buf_len) return ESP_ERR_MODBUS_RTU_FRAME;
+    memcpy(buf, f->adu, f->len);
+    *out_len = f->len;
+    return ESP_OK;
+}
+
+static void pipe_deinit(void *ctx)
+{
+    (void)ctx;
+}
+
+static const modbus_rtu_transport_t pipe_transport = {
+    .init = pipe_init,
+    .write_adu = pipe_write_adu,
+    .read_frame = pipe_read_frame,
+    .deinit = pipe_deinit,
+};
+
+static StaticQueue_t q_buf[2];
+static uint8_t q_storage[2][2 * sizeof(pipe_frame_t)];
+static pipe_end_t master_end, slave_end;
+
+// ---------------- slave ----------------
+
+#define REGS 128
+static uint16_t regs[REGS];
+static uint8_t coils[REGS / 8];
+
+static esp_err_t read_regs(uint16_t addr, uint16_t qty, uint16_t *dest, void *user)
+{
+    (void)user;
+    if ((uint32_t)addr + qty > REGS) return ESP_ERR_INVALID_SIZE;
+    memcpy(dest, &regs[addr], qty * sizeof(uint16_t));
+    return ESP_OK;
+}
+
+static esp_err_t write_regs(uint16_t addr, uint16_t qty, const uint16_t *src, void *user)
+{
+    (void)user;
+    if ((uint32_t)addr + qty > REGS) return ESP_ERR_INVALID_SIZE;
+    memcpy(&regs[addr], src, qty * sizeof(uint16_t));
+    return ESP_OK;
+}
+
+static esp_err_t read_coils(uint16_t addr, uint16_t qty, uint8_t *dest, void *user)
+{
+    (void)user;
+    if ((uint32_t)addr + qty > REGS) return ESP_ERR_INVALID_SIZE;
+    for (uint16_t i = 0; i < qty; ++i) {
+        uint16_t b = addr + i;
+        if (coils[b / 8] & (1u << (b % 8))) dest[i / 8] |= (uint8_t)(1u << (i % 8));
+    }
+    return ESP_OK;
+}
+
+static esp_err_t write_coils(uint16_t addr, uint16_t qty, const uint8_t *src, void *user)
+{
+    (void)user;
+    if ((uint32_t)addr + qty > REGS) return ESP_ERR_INVALID_SIZE;
+    for (uint16_t i = 0; i < qty; ++i) {
+        uint16_t b = addr + i;
+        if (src[i / 8] & (1u << (i % 8))) coils[b / 8] |= (uint8_t)(1u << (b % 8));
+        else coils[b / 8] &= (uint8_t)~(1u << (b % 8));
+    }
+    return ESP_OK;
+}
+
+static modbus_rtu_slave_static_t slave_storage;
+static modbus_rtu_master_static_t master_storage;
+static modbus_rtu_t *slave, *master;
+
+// ---------------- probes ----------------
+// Each probe makes one call with the largest request the API takes.
+
+static uint16_t buf[MODBUS_RTU_READ_SPAN_CHUNKS(REGS) * 125];
+static uint8_t bits[REGS];
+static modbus_rtu_exception_t ex;
+
+static esp_err_t probe_nothing(void) { return ESP_OK; }
+
+static esp_err_t probe_read_holding(void)
+{
+    return modbus_rtu_read_holding_registers(master, 1, 0, 125, buf, 125, &ex);
+}
+
+static esp_err_t probe_write_multiple(void)
+{
+    return modbus_rtu_write_multiple_registers(master, 1, 0, 123, buf, 123, &ex);
+}
+
+static esp_err_t probe_readwrite(void)
+{
+    return modbus_rtu_readwrite_multiple_registers(master, 1, 0, 100, 0, 100, buf, 100, buf, 100, &ex);
+}
+
+static esp_err_t probe_mask_write(void)
+{
+    return modbus_rtu_mask_write_register(master, 1, 3, 0x00FF, 0x1200, &ex);
+}
+
+static esp_err_t probe_read_coils(void)
+{
+    return modbus_rtu_read_coils(master, 1, 0, REGS, bits, REGS, &ex);
+}
+
+static esp_err_t probe_write_coils(void)
+{
+    return modbus_rtu_write_multiple_coils(master, 1, 0, REGS, bits, REGS, &ex);
+}
+
+static esp_err_t probe_read_coils_packed(void)
+{
+    return modbus_rtu_read_coils_packed(master, 1, 0, REGS, bits, REGS / 8, &ex);
+}
+
+static esp_err_t probe_transaction(void)
+{
+    static uint8_t rsp[MODBUS_RTU_PDU_MAX];
+    const uint8_t req[] = { 0x03, 0x00, 0x00, 0x00, 0x7D };
+    size_t len;
+    return modbus_rtu_master_transaction(master, 1, req, sizeof(req), rsp, sizeof(rsp), &len, &ex);
+}
+
+static esp_err_t probe_read_typed(void)
+{
+    static float f[31];
+    modbus_rtu_layout_t l = { MODBUS_RTU_TYPE_F32, MODBUS_RTU_ORDER_CDAB };
+    return modbus_rtu_read_typed(master, 1, MODBUS_RTU_TABLE_HOLDING, 0, 31, l, f, &ex);
+}
+
+static esp_err_t probe_write_typed(void)
+{
+    static double d[30];
+    modbus_rtu_layout_t l = { MODBUS_RTU_TYPE_F64, MODBUS_RTU_ORDER_ABCD };
+    return modbus_rtu_write_typed(master, 1, 0, 30, l, d, &ex);
+}
+
+static esp_err_t probe_read_span(void)
+{
+    static modbus_rtu_span_chunk_t chunks[MODBUS_RTU_READ_SPAN_CHUNKS(REGS)];
+    size_t n;
+    return modbus_rtu_read_span(master, 1, MODBUS_RTU_TABLE_HOLDING, 0, REGS, buf, chunks,
+                                sizeof(chunks) / sizeof(chunks[0]), &n);
+}
+
+static esp_err_t probe_write_span(void)
+{
+    return modbus_rtu_write_span(master, 1, 0, REGS, buf, NULL, 0, NULL);
+}
+
+static modbus_rtu_compiled_t *compiled[2];
+
+static void batch_cb(size_t index, esp_err_t err, const modbus_rtu_exception_t *e,
+                     const uint8_t *rsp, size_t rsp_len, void *user)
+{
+    (void)index; (void)err; (void)e; (void)rsp; (void)rsp_len; (void)user;
+}
+
+static esp_err_t probe_run_batch(void)
+{
+    return modbus_rtu_master_run_batch(master, (const modbus_rtu_compiled_t *const*)compiled, 2, batch_cb, NULL);
+}
+
+typedef struct {
+    const char *name;
+    esp_err_t (*fn)(void);
+} probe_t;
+
+static const probe_t probes[] = {
+    { "read_holding_registers",    probe_read_holding },
+    { "write_multiple_registers",  probe_write_multiple },
+    { "readwrite_multiple",        probe_readwrite },
+    { "mask_write_register",       probe_mask_write },
+    { "read_coils",                probe_read_coils },
+    { "write_multiple_coils",      probe_write_coils },
+    { "read_coils_packed",         probe_read_coils_packed },
+    { "master_transaction",        probe_transaction },
+    { "read_typed",                probe_read_typed },
+    { "write_typed",               probe_write_typed },
+    { "read_span",                 probe_read_span },
+    { "write_span",                probe_write_span },
+    { "master_run_batch",          probe_run_batch },
+};
+
+// FC03/04 reads, the ones the cache serves
+static const probe_t cached_probes[] = {
+    { "read_holding_registers",    probe_read_holding },
+    { "read_typed",                probe_read_typed },
+    { "read_span",                 probe_read_span },
+};
+
+#define PROBE_STACK 4096
+static StackType_t probe_stack[PROBE_STACK / sizeof(StackType_t)];
+static StaticTask_t probe_tcb;
+
+typedef struct {
+    esp_err_t (*fn)(void);
+    esp_err_t err;
+    size_t used;
+    TaskHandle_t waiter;
+} probe_run_t;
+
+static void probe_task(void *arg)
+{
+    probe_run_t *r = (probe_run_t*)arg;
+    r->err = r->fn();
+    r->used = PROBE_STACK - uxTaskGetStackHighWaterMark(NULL) * sizeof(StackType_t);
+    xTaskNotifyGive(r->waiter);
+    for (;;) vTaskSuspend(NULL);
+}
+
+// Stack bytes used by fn on a fresh stack, probe frames included
+static size_t probe_run(esp_err_t (*fn)(void), esp_err_t *err)
+{
+    probe_run_t r = { .fn = fn, .waiter = xTaskGetCurrentTaskHandle() };
+    TaskHandle_t t = xTaskCreateStatic(probe_task, "mb_probe", PROBE_STACK / sizeof(StackType_t), &r, 5,
+                                       probe_stack, &probe_tcb);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    // The TCB and stack are reused by the next probe: delete while parked
+    while (eTaskGetState(t) != eSuspended) vTaskDelay(1);
+    vTaskDelete(t);
+    *err = r.err;
+    return r.used;
+}
+
+// Number of probes over the bound or failed: a failed call may have
+// returned before its deepest path, so its figure proves nothing
+static int probe_pass(const char *mode, const probe_t *p, size_t n, size_t base)
+{
+    int over = 0;
+    ESP_LOGI(TAG, "%-26s %6s  (bound %d)", mode, "bytes", MODBUS_RTU_STACK_MASTER_CALL);
+    for (size_t i = 0; i < n; ++i) {
+        esp_err_t err;
+        modbus_rtu_master_cache_invalidate(master, 0);
+        size_t used = probe_run(p[i].fn, &err) - base;
+        bool ok = used <= MODBUS_RTU_STACK_MASTER_CALL;
+        if (!ok || err != ESP_OK) over++;
+        ESP_LOGI(TAG, "%-26s %6u  %s", p[i].name, (unsigned)used,
+                 err != ESP_OK ? "FAILED" : ok ? "ok" : "OVER");
+    }
+    return over;
+}
+
+void app_main(void)
+{
+    master_end.rx = xQueueCreateStatic(2, sizeof(pipe_frame_t), q_storage[0], &q_buf[0]);
+    slave_end.rx = xQueueCreateStatic(2, sizeof(pipe_frame_t), q_storage[1], &q_buf[1]);
+    master_end.tx = slave_end.rx;
+    slave_end.tx = master_end.rx;
+
+    modbus_rtu_uart_config_t ucfg = {
+        .baudrate = 115200,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .data_bits = UART_DATA_8_BITS,
+        .transport = &pipe_transport,
+        .transport_ctx = &slave_end,
+    };
+    modbus_rtu_slave_config_t scfg = { .unit_id = 1, .rx_poll_delay_ms = 1 };
+    modbus_rtu_slave_cb_t cb = {
+        .read_coils = read_coils,
+        .write_coils = write_coils,
+        .read_holding = read_regs,
+        .write_holding = write_regs,
+        .read_input = read_regs,
+    };
+    ESP_ERROR_CHECK(modbus_rtu_slave_create_static(&ucfg, &scfg, &cb, NULL, &slave_storage, &slave));
+    ESP_ERROR_CHECK(modbus_rtu_slave_start(slave));
+
+    ucfg.transport_ctx = &master_end;
+    modbus_rtu_master_config_t mcfg = { .response_timeout_ms = 200 };
+    ESP_ERROR_CHECK(modbus_rtu_master_create_static(&ucfg, &mcfg, &master_storage, &master));
+
+    ESP_ERROR_CHECK(modbus_rtu_compile_read(1, MODBUS_RTU_TABLE_HOLDING, 0, 125, &compiled[0]));
+    ESP_ERROR_CHECK(modbus_rtu_compile_read(1, MODBUS_RTU_TABLE_COILS, 0, REGS, &compiled[1]));
+
+    esp_err_t err;
+    size_t base = probe_run(probe_nothing, &err);
+    int over = 0;
+
+    const size_t n_probes = sizeof(probes) / sizeof(probes[0]);
+    over += probe_pass("master API", probes, n_probes, base);
+    ESP_ERROR_CHECK(modbus_rtu_master_adaptive_enable(master, NULL));
+    over += probe_pass("+ adaptive", probes, n_probes, base);
+    ESP_ERROR_CHECK(modbus_rtu_master_cache_enable(master, NULL));
+    over += probe_pass("+ adaptive + cache", cached_probes, sizeof(cached_probes) / sizeof(cached_probes[0]), base);
+    modbus_rtu_master_cache_disable(master);
+    modbus_rtu_master_adaptive_disable(master);
+
+    TaskHandle_t st = xTaskGetHandle("mb_slave");
+    size_t slave_used = sizeof(slave_storage.stack) - uxTaskGetStackHighWaterMark(st) * sizeof(StackType_t);
+    bool slave_ok = slave_used <= MODBUS_RTU_STACK_SLAVE_TASK;
+    if (!slave_ok) over++;
+    ESP_LOGI(TAG, "%-26s %6u  %s  (bound %d)", "slave task", (unsigned)slave_used, slave_ok ? "ok" : "OVER",
+             MODBUS_RTU_STACK_SLAVE_TASK);
+
+    if (over) ESP_LOGE(TAG, "%d figure(s) failed or over their documented bound", over);
+    else ESP_LOGI(TAG, "all within documented bounds");
+
+    modbus_rtu_compiled_free(compiled[0]);
+    modbus_rtu_compiled_free(compiled[1]);
+    modbus_rtu_destroy(master);
+    modbus_rtu_destroy(slave);
+}
@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""Decode and analyse Modbus RTU captures written by modbus_rtu_capture_export_pcap().
+
+  mbcap.py decode  capture.pcap     one line per frame
+  mbcap.py timing  capture.pcap     replays the capture: inter-frame gaps and
+                                    per-unit slave response times
+
+Standard library only.
+"""
+
+import argparse
+import struct
+import sys
+
+LINKTYPE_USER0 = 147
+PSEUDO = struct.Struct('>BBHi')     # direction, role, wire length, esp_err_t result
+ROLE_SLAVE = 2
+
+ERRORS = {
+    0: 'OK',
+    0x101: 'NO_MEM',
+    0x103: 'INVALID_STATE',
+    0x105: 'NOT_FOUND',
+    0x107: 'TIMEOUT',
+    0x31001: 'RTU_TIMEOUT',
+    0x31002: 'RTU_CRC',
+    0x31003: 'RTU_BAD_RESPONSE',
+    0x31004: 'RTU_EXCEPTION',
+    0x31005: 'RTU_PORT',
+    0x31006: 'RTU_FRAME',
+    0x31007: 'RTU_OFFLINE',
+}
+
+FUNCTIONS = {
+    0x01: 'read coils',
+    0x02: 'read discrete inputs',
+    0x03: 'read holding',
+    0x04: 'read input',
+    0x05: 'write coil',
+    0x06: 'write register',
+    0x0F: 'write coils',
+    0x10: 'write registers',
+    0x16: 'mask write',
+    0x17: 'read/write registers',
+}
+
+
+class Frame:
+    __slots__ = ('t_us', 'rx', 'slave', 'wire_len', 'result', 'adu')
+
+    def __init__(self, t_us, rx, slave, wire_len, result, adu):
+        self.t_us = t_us
+        self.rx = rx
+        self.slave = slave
+        self.wire_len = wire_len
+        self.result = result
+        self.adu = adu
+
+    @property
+    def request(self):
+        # A master sends requests; a slave receives them
+        return self.rx == self.slave
+
+    @property
+    def truncated(self):
+        return len(self.adu) < self.wire_len
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def read_pcap(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if len(data) < 24:
+        raise ValueError('not a pcap file')
+    magic = struct.unpack_from('<I', data)[0]
+    if magic == 0xA1B2C3D4:
+        e = '<'
+    elif magic == 0xD4C3B2A1:
+        e = '>'
+    else:
+        raise ValueError('not a pcap file (magic %08x)' % magic)
+    linktype = struct.unpack_from(e + 'I', data, 20)[0]
+    if linktype != LINKTYPE_USER0:
+        raise ValueError('unexpected link type %d' % linktype)
+
+    frames = []
+    off = 24
+    while off + 16 <= len(data):
+        sec, usec, incl, _orig = struct.unpack_from(e + 'IIII', data, off)
+        off += 16
+        pkt = data[off:off + incl]
+        off += incl
+        if len(pkt) < PSEUDO.size:
+            break
+        direction, role, wire_len, result = PSEUDO.unpack_from(pkt)
+        frames.append(Frame(sec * 1000000 + usec, direction == 1, role == ROLE_SLAVE, wire_len, result,
+                            pkt[PSEUDO.size:]))
+    return frames
+
+
+def crc_ok(fr):
+    a = fr.adu
+    if fr.truncated or len(a) < 4:
+        return None
+    return crc16(a[:-2]) == (a[-2] | (a[-1] << 8))
+
+
+def describe(fr):
+    a = fr.adu
+    if len(a) < 2:
+        return '(%d bytes)' % len(a)
+    unit, fc = a[0], a[1]
+    if fc & 0x80:
+        code = a[2] if len(a) > 2 else 0
+        return 'unit %d exception fc=0x%02x code=%d' % (unit, fc & 0x7F, code)
+    name = FUNCTIONS.get(fc, 'fc=0x%02x' % fc)
+    text = 'unit %d %s' % (unit, name)
+    if fr.request and fc in (0x01, 0x02, 0x03, 0x04, 0x0F, 0x10, 0x17) and len(a) >= 6:
+        addr, qty = struct.unpack_from('>HH', a, 2)
+        text += ' addr=%d qty=%d' % (addr, qty)
+    elif fc in (0x05, 0x06) and len(a) >= 6:
+        addr, value = struct.unpack_from('>HH', a, 2)
+        text += ' addr=%d value=0x%04x' % (addr, value)
+    elif not fr.request and fc in (0x01, 0x02, 0x03, 0x04, 0x17) and len(a) >= 3:
+        text += ' bytes=%d' % a[2]
+    return text
+
+
+def cmd_decode(frames, _args):
+    t0 = frames[0].t_us if frames else 0
+    prev = None
+    for fr in frames:
+        gap = '' if prev is None else '+%d' % (fr.t_us - prev)
+        prev = fr.t_us
+        crc = {None: '   ', True: 'ok ', False: 'CRC'}[crc_ok(fr)]
+        res = '' if fr.result == 0 else ' [%s]' % ERRORS.get(fr.result, hex(fr.result))
+        trunc = ' (truncated from %d)' % fr.wire_len if fr.truncated else ''
+        print('%12.6f %10s %s %3d %s %-48s %s%s%s' % (
+            (fr.t_us - t0) / 1e6, gap, 'RX' if fr.rx else 'TX', fr.wire_len, crc,
+            describe(fr), fr.adu.hex(' '), res, trunc))
+
+
+def percentile(values, p):
+    s = sorted(values)
+    return s[min(len(s) - 1, int(p / 100.0 * len(s)))]
+
+
+def summary(values):
+    if not values:
+        return 'n=0'
+    return 'n=%d min=%d avg=%d p95=%d max=%d' % (
+        len(values), min(values), sum(values) // len(values), percentile(values, 95), max(values))
+
+
+def cmd_timing(frames, args):
+    # Replay the timeline: a request opens a transaction, the next frame the
+    # other way with the same unit id answers it. Timestamps are taken when
+    # each port call returns, i.e. at the end of the frame.
+    gaps = []
+    response = {}
+    no_response = {}
+    pending = None
+    prev = None
+    for fr in frames:
+        if prev is not None:
+            gaps.append(fr.t_us - prev.t_us)
+        prev = fr
+        unit = fr.adu[0] if fr.adu else None
+        if fr.request:
+            if pending is not None:
+                no_response[pending.adu[0]] = no_response.get(pending.adu[0], 0) + 1
+            pending = fr if unit else None      # broadcasts get no reply
+            continue
+        if pending is not None and unit == pending.adu[0]:
+            response.setdefault(unit, []).append(fr.t_us - pending.t_us)
+            pending = None
+
+    print('frames            %d (%d TX, %d RX)' % (len(frames), sum(not f.rx for f in frames), sum(f.rx for f in frames)))
+    print('crc errors        %d' % sum(crc_ok(f) is False for f in frames))
+    print('inter-frame gap   %s us' % summary(gaps))
+    if args.gap_us:
+        late = [g for g in gaps if g > args.gap_us]
+        print('gaps > %d us    %d' % (args.gap_us, len(late)))
+    print('response time per unit (end of request to end of response, us):')
+    for unit in sorted(set(response) | set(no_response)):
+        print('  unit %3d  %s  unanswered=%d' % (unit, summary(response.get(unit, [])), no_response.get(unit, 0)))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest='cmd', required=True)
+    p = sub.add_parser('decode', help='list frames')
+    p.add_argument('file')
+    p.set_defaults(func=cmd_decode)
+    p = sub.add_parser('timing', help='gap and response-time statistics')
+    p.add_argument('file')
+    p.add_argument('--gap-us', type=int, default=0, help='also count gaps longer than this')
+    p.set_defaults(func=cmd_timing)
+    args = ap.parse_args()
+
+    try:
+        frames = read_pcap(args.file)
+    except (OSError, ValueError) as e:
+        sys.exit('%s: %s' % (args.file, e))
+    args.func(frames, args)
+
+
+if __name__ == '__main__':
+    main()